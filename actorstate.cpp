@@ -0,0 +1,79 @@
+#include "actorstate.h"
+
+ActorState makeActorState(int entityId, int animationNo)
+{
+    ActorState state;
+    state.mEntityId = entityId;
+    state.mAnimationNo = animationNo;
+    state.mAnimationStep = 0;
+    state.mRemainingAnimationTime = 0;
+    state.mIsFacingRight = 1;
+    state.mPosition = Vector3D(0, 0, 0);
+    state.mScale = 1.0;
+    state.mDirtyFlags = 0;
+    return state;
+}
+
+static void snapshotActorAnimation(ActorState* state)
+{
+    state->mAnimationNo = getBlitzMugenAnimationAnimationNumber(state->mEntityId);
+    state->mAnimationStep = getBlitzMugenAnimationAnimationStep(state->mEntityId);
+    state->mRemainingAnimationTime = getBlitzMugenAnimationRemainingAnimationTime(state->mEntityId);
+}
+
+void snapshotActorStates(ActorState* states, size_t amount)
+{
+    for (size_t i = 0; i < amount; i++)
+    {
+        auto& state = states[i];
+        snapshotActorAnimation(&state);
+        // Values written since the last write back are newer than what blitz has
+        if (!(state.mDirtyFlags & ACTOR_STATE_DIRTY_FACE)) state.mIsFacingRight = getBlitzMugenAnimationIsFacingRight(state.mEntityId);
+        if (!(state.mDirtyFlags & ACTOR_STATE_DIRTY_POSITION)) state.mPosition = getBlitzEntityPosition(state.mEntityId);
+    }
+}
+
+void writeBackActorStates(ActorState* states, size_t amount)
+{
+    for (size_t i = 0; i < amount; i++)
+    {
+        auto& state = states[i];
+        if (!state.mDirtyFlags) continue;
+        if (state.mDirtyFlags & ACTOR_STATE_DIRTY_POSITION) *getBlitzEntityPositionReference(state.mEntityId) = state.mPosition;
+        if (state.mDirtyFlags & ACTOR_STATE_DIRTY_SCALE) setBlitzMugenAnimationBaseDrawScale(state.mEntityId, state.mScale);
+        if (state.mDirtyFlags & ACTOR_STATE_DIRTY_FACE) setBlitzMugenAnimationFaceDirection(state.mEntityId, state.mIsFacingRight);
+        state.mDirtyFlags = 0;
+    }
+}
+
+// Animation changes go through immediately since they reset step and timing, which later checks in the same frame read
+void changeActorAnimation(ActorState* state, int animationNo)
+{
+    changeBlitzMugenAnimation(state->mEntityId, animationNo);
+    snapshotActorAnimation(state);
+}
+
+void changeActorAnimationIfDifferent(ActorState* state, int animationNo)
+{
+    if (state->mAnimationNo == animationNo) return;
+    changeActorAnimation(state, animationNo);
+}
+
+void setActorPosition(ActorState* state, const Vector3D& position)
+{
+    state->mPosition = position;
+    state->mDirtyFlags |= ACTOR_STATE_DIRTY_POSITION;
+}
+
+void setActorScale(ActorState* state, double scale)
+{
+    state->mScale = scale;
+    state->mDirtyFlags |= ACTOR_STATE_DIRTY_SCALE;
+}
+
+void setActorFaceDirection(ActorState* state, int isFacingRight)
+{
+    if (state->mIsFacingRight == isFacingRight) return;
+    state->mIsFacingRight = isFacingRight;
+    state->mDirtyFlags |= ACTOR_STATE_DIRTY_FACE;
+}
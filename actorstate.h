@@ -0,0 +1,31 @@
+#pragma once
+
+#include <prism/blitz.h>
+
+#define ACTOR_STATE_DIRTY_POSITION 1
+#define ACTOR_STATE_DIRTY_SCALE 2
+#define ACTOR_STATE_DIRTY_FACE 4
+
+// Per-frame copy of the blitz state an actor update reads, writes are collected here and applied in one pass
+struct ActorState
+{
+    int mEntityId;
+    int mAnimationNo;
+    int mAnimationStep;
+    int mRemainingAnimationTime;
+    int mIsFacingRight;
+    Vector3D mPosition;
+    double mScale;
+    uint8_t mDirtyFlags;
+};
+
+ActorState makeActorState(int entityId, int animationNo);
+
+void snapshotActorStates(ActorState* states, size_t amount);
+void writeBackActorStates(ActorState* states, size_t amount);
+
+void changeActorAnimation(ActorState* state, int animationNo);
+void changeActorAnimationIfDifferent(ActorState* state, int animationNo);
+void setActorPosition(ActorState* state, const Vector3D& position);
+void setActorScale(ActorState* state, double scale);
+void setActorFaceDirection(ActorState* state, int isFacingRight);
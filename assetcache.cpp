@@ -0,0 +1,229 @@
+#include "assetcache.h"
+
+#include <prism/file.h>
+#include <prism/system.h>
+
+struct CachedAsset
+{
+    MugenSpriteFile mSprites;
+    MugenAnimations mAnimations;
+    MugenSounds mSounds;
+    size_t mSize;
+    int mReferenceCount;
+    uint64_t mLastUsed;
+    bool mIsPersistent;
+};
+
+static struct
+{
+    std::map<std::string, CachedAsset> mAssets;
+    size_t mBudget = SIZE_MAX;
+    size_t mPersistentSize = 0;
+    size_t mScreenSize = 0;
+    uint64_t mUseCounter = 0;
+    // Handed out for files that do not exist, it never enters mAssets so nothing is sized, loaded or counted against the budget
+    CachedAsset mMissingAsset;
+} gAssetCacheData;
+
+void setAssetCacheMemoryBudget(size_t budgetInBytes)
+{
+    gAssetCacheData.mBudget = budgetInBytes;
+}
+
+static bool hasExtension(const std::string& path, const char* extension)
+{
+    auto length = strlen(extension);
+    if (path.size() < length) return false;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (tolower(path[path.size() - length + i]) != extension[i]) return false;
+    }
+    return true;
+}
+
+#define SFF_SPRITE_LIST_HEADER_OFFSET 0x24
+#define SFF_SPRITE_NODE_SIZE 28
+
+// The Dreamcast's PVR only takes power of two textures, so sprites there occupy the padded size
+static size_t getTextureDimension(uint16_t size)
+{
+    if (!isOnDreamcast()) return size;
+    size_t padded = 8;
+    while (padded < size) padded <<= 1;
+    return padded;
+}
+
+// Sprites are decoded into 32 bit textures, so the SFF's sprite index gives their size without decoding anything
+static size_t getSpriteFileTextureSize(FileHandler file)
+{
+    uint32_t spriteList[2];
+    fileSeek(file, SFF_SPRITE_LIST_HEADER_OFFSET, SEEK_SET);
+    if (fileRead(file, spriteList, sizeof(spriteList)) != sizeof(spriteList)) return 0;
+
+    size_t size = 0;
+    fileSeek(file, spriteList[0], SEEK_SET);
+    for (uint32_t i = 0; i < spriteList[1]; i++)
+    {
+        uint8_t node[SFF_SPRITE_NODE_SIZE];
+        if (fileRead(file, node, sizeof(node)) != sizeof(node)) break;
+        uint16_t width = uint16_t(node[4] | (node[5] << 8));
+        uint16_t height = uint16_t(node[6] | (node[7] << 8));
+        bool isLinked = !(node[20] | node[21] | node[22] | node[23]);
+        if (!isLinked) size += getTextureDimension(width) * getTextureDimension(height) * 4;
+    }
+    return size;
+}
+
+static size_t getAssetSize(const std::string& path)
+{
+    auto file = fileOpen(path.c_str(), O_RDONLY);
+    if (file == FILEHND_INVALID) return 0;
+    // For everything but sprites the file size stands in for the decoded size, good enough to keep the Dreamcast build in its lane
+    auto size = hasExtension(path, ".sff") ? getSpriteFileTextureSize(file) : fileTotal(file);
+    fileClose(file);
+    return size;
+}
+
+static void loadAssetIntoCache(const std::string& path, CachedAsset& asset)
+{
+    if (hasExtension(path, ".sff"))
+    {
+        asset.mSprites = loadMugenSpriteFileWithoutPalette(path);
+    }
+    else if (hasExtension(path, ".air"))
+    {
+        asset.mAnimations = loadMugenAnimationFile(path);
+    }
+    else if (hasExtension(path, ".snd"))
+    {
+        asset.mSounds = loadMugenSoundFile(path.c_str());
+    }
+    else
+    {
+        logErrorFormat("Unrecognized cached asset type: %s", path.c_str());
+    }
+}
+
+static void unloadAssetFromCache(const std::string& path, CachedAsset& asset)
+{
+    if (hasExtension(path, ".sff"))
+    {
+        unloadMugenSpriteFile(&asset.mSprites);
+    }
+    else if (hasExtension(path, ".air"))
+    {
+        unloadMugenAnimationFile(&asset.mAnimations);
+    }
+    else if (hasExtension(path, ".snd"))
+    {
+        unloadMugenSoundFile(&asset.mSounds);
+    }
+}
+
+// Only unreferenced persistent assets can go, screen assets are freed on release or with their screen
+static void evictLeastRecentlyUsedUntil(size_t targetSize)
+{
+    while (gAssetCacheData.mPersistentSize + gAssetCacheData.mScreenSize > targetSize)
+    {
+        auto victim = gAssetCacheData.mAssets.end();
+        for (auto it = gAssetCacheData.mAssets.begin(); it != gAssetCacheData.mAssets.end(); it++)
+        {
+            if (!it->second.mIsPersistent || it->second.mReferenceCount) continue;
+            if (victim == gAssetCacheData.mAssets.end() || it->second.mLastUsed < victim->second.mLastUsed)
+            {
+                victim = it;
+            }
+        }
+        if (victim == gAssetCacheData.mAssets.end()) return;
+
+        unloadAssetFromCache(victim->first, victim->second);
+        gAssetCacheData.mPersistentSize -= victim->second.mSize;
+        gAssetCacheData.mAssets.erase(victim);
+    }
+}
+
+static void makeRoomForAsset(size_t size)
+{
+    if (gAssetCacheData.mPersistentSize + gAssetCacheData.mScreenSize + size <= gAssetCacheData.mBudget) return;
+    evictLeastRecentlyUsedUntil(gAssetCacheData.mBudget > size ? gAssetCacheData.mBudget - size : 0);
+}
+
+// Must be called outside of screen handling, otherwise the screen's memory stack frees the asset on the next screen change
+void preloadCachedAsset(const std::string& path)
+{
+    if (gAssetCacheData.mAssets.find(path) != gAssetCacheData.mAssets.end()) return;
+    if (!isFile(path)) return;
+
+    auto size = getAssetSize(path);
+    if (size > gAssetCacheData.mBudget) return;
+    makeRoomForAsset(size);
+    if (gAssetCacheData.mPersistentSize + gAssetCacheData.mScreenSize + size > gAssetCacheData.mBudget) return;
+
+    auto& asset = gAssetCacheData.mAssets[path];
+    loadAssetIntoCache(path, asset);
+    asset.mSize = size;
+    asset.mReferenceCount = 0;
+    asset.mLastUsed = gAssetCacheData.mUseCounter++;
+    asset.mIsPersistent = true;
+    gAssetCacheData.mPersistentSize += size;
+}
+
+static CachedAsset& acquireCachedAsset(const std::string& path)
+{
+    auto it = gAssetCacheData.mAssets.find(path);
+    if (it == gAssetCacheData.mAssets.end())
+    {
+        if (!isFile(path))
+        {
+            logWarningFormat("Cached asset %s does not exist, using an empty one", path.c_str());
+            return gAssetCacheData.mMissingAsset;
+        }
+
+        // Not preloaded or over budget, so it lives and dies with the current screen.
+        // Persistent assets nobody holds right now make way for it first.
+        auto size = getAssetSize(path);
+        makeRoomForAsset(size);
+        auto& asset = gAssetCacheData.mAssets[path];
+        loadAssetIntoCache(path, asset);
+        asset.mSize = size;
+        gAssetCacheData.mScreenSize += size;
+        asset.mReferenceCount = 0;
+        asset.mIsPersistent = false;
+        it = gAssetCacheData.mAssets.find(path);
+    }
+
+    auto& asset = it->second;
+    asset.mReferenceCount++;
+    asset.mLastUsed = gAssetCacheData.mUseCounter++;
+    return asset;
+}
+
+MugenSpriteFile* acquireCachedMugenSpriteFile(const std::string& path)
+{
+    return &acquireCachedAsset(path).mSprites;
+}
+
+MugenAnimations* acquireCachedMugenAnimations(const std::string& path)
+{
+    return &acquireCachedAsset(path).mAnimations;
+}
+
+MugenSounds* acquireCachedMugenSounds(const std::string& path)
+{
+    return &acquireCachedAsset(path).mSounds;
+}
+
+void releaseCachedAsset(const std::string& path)
+{
+    auto it = gAssetCacheData.mAssets.find(path);
+    if (it == gAssetCacheData.mAssets.end()) return;
+
+    auto& asset = it->second;
+    asset.mReferenceCount = max(0, asset.mReferenceCount - 1);
+    if (!asset.mIsPersistent && !asset.mReferenceCount)
+    {
+        unloadAssetFromCache(it->first, asset);
+        gAssetCacheData.mScreenSize -= asset.mSize;
+        gAssetCacheData.mAssets.erase(it);
+    }
+}
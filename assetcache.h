@@ -0,0 +1,11 @@
+#pragma once
+
+#include <prism/blitz.h>
+
+void setAssetCacheMemoryBudget(size_t budgetInBytes);
+void preloadCachedAsset(const std::string& path);
+
+MugenSpriteFile* acquireCachedMugenSpriteFile(const std::string& path);
+MugenAnimations* acquireCachedMugenAnimations(const std::string& path);
+MugenSounds* acquireCachedMugenSounds(const std::string& path);
+void releaseCachedAsset(const std::string& path);
@@ -4,6 +4,9 @@
 #include <prism/soundeffect.h>
 
 #include "gamescreen.h"
+#include "assetcache.h"
+#include "storytable.h"
+#include "musicstream.h"
 struct
 {
 	std::string mBookName = "intro";
@@ -17,17 +20,8 @@ void gotoVNScreenCB(void*);
 class BookScreen {
 public:
 
-	struct BookTextPart
-	{
-		std::string text;
-	};
-
-	struct BookText
-	{
-		std::vector<BookTextPart> mParts;
-	};
-
-	std::map<std::string, BookText> mTexts;
+	StoryTable mStoryTable;
+	StoryBook mActiveBook;
 	BookScreen()
 	{
 		loadBookTexts();
@@ -35,61 +29,59 @@ public:
 		loadScreenEntities();
 		setTextActive();
 		resetGame();
-		streamMusicFile("game/STORY.ogg");
+		startMusicStream("game/STORY.ogg");
 	}
-
-	void loadBookTexts()
+	~BookScreen()
 	{
-		MugenDefScript script;
-		loadMugenDefScript(&script, "game/STORY.def");
-		MugenDefScriptGroup* group = script.mFirstGroup;
-		while (group)
-		{
-			loadBookTextFromSingleGroup(group);
-			group = group->mNext;
-		}
-
-		unloadMugenDefScript(&script);
+		unloadFiles();
+		unloadStoryTable(&mStoryTable);
 	}
 
-	void loadBookTextFromSingleGroup(MugenDefScriptGroup* group)
+	void loadBookTexts()
 	{
-		auto& conversation = mTexts[group->mName];
-		auto iterator = list_iterator_begin(&group->mOrderedElementList);
-		while (iterator)
-		{
-			BookTextPart part;
-			MugenDefScriptGroupElement* element = (MugenDefScriptGroupElement*)list_iterator_get(iterator);
-			part.text = getSTLMugenDefStringVariableAsElementForceAddWhiteSpaces(element);
-			conversation.mParts.push_back(part);
-
-			if (!list_has_next(iterator))
-			{
-				iterator = nullptr;
-			}
-			else {
-				list_iterator_increase(&iterator);
-			}
-		}
+		loadStoryTable(&mStoryTable, "game/STORY.bin");
 	}
 
-	MugenSpriteFile mSprites;
-	MugenAnimations mAnimations;
-	MugenSounds mSounds;
-	MugenSounds mSoundsGeneral;
-	BookText* mActiveBookText;
+	MugenSpriteFile* mSprites;
+	MugenAnimations* mAnimations;
+	MugenSounds* mSounds;
+	MugenSounds* mSoundsGeneral;
+	std::string mFilePathBase;
 
 	void loadFiles()
 	{
 		turnStringUppercase(gBookScreenData.mBookName);
-		mSprites = loadMugenSpriteFileWithoutPalette(std::string("game/") + gBookScreenData.mBookName +".sff");
-		mAnimations = loadMugenAnimationFile(std::string("game/") + gBookScreenData.mBookName + ".air");
-		mSounds = loadMugenSoundFile((std::string("game/") + gBookScreenData.mBookName + ".snd").c_str());
-		mSoundsGeneral = loadMugenSoundFile("game/BOOK.snd");
+		mFilePathBase = std::string("game/") + gBookScreenData.mBookName;
+		mSprites = acquireCachedMugenSpriteFile(mFilePathBase + ".sff");
+		mAnimations = acquireCachedMugenAnimations(mFilePathBase + ".air");
+		mSounds = acquireCachedMugenSounds(mFilePathBase + ".snd");
+		mSoundsGeneral = acquireCachedMugenSounds("game/BOOK.snd");
 
 		turnStringLowercase(gBookScreenData.mBookName);
-		assert(mTexts.find(gBookScreenData.mBookName) != mTexts.end());
-		mActiveBookText = &mTexts[gBookScreenData.mBookName];
+		selectActiveBook();
+	}
+
+	void selectActiveBook()
+	{
+		mActiveBook = getStoryTableBook(&mStoryTable, gBookScreenData.mBookName);
+	}
+
+	const char* getPageText(int page)
+	{
+		return getStoryBookPage(mActiveBook, page);
+	}
+
+	int getPageAmount()
+	{
+		return mActiveBook.mPageAmount;
+	}
+
+	void unloadFiles()
+	{
+		releaseCachedAsset(mFilePathBase + ".sff");
+		releaseCachedAsset(mFilePathBase + ".air");
+		releaseCachedAsset(mFilePathBase + ".snd");
+		releaseCachedAsset("game/BOOK.snd");
 	}
 
 	int mLeftAnimationBG;
@@ -101,16 +93,16 @@ public:
 	void loadScreenEntities()
 	{
 		mLeftAnimationBG = addBlitzEntity(Vector3D(160, 0, 1));
-		addBlitzMugenAnimationComponent(mLeftAnimationBG, &mSprites, &mAnimations, -1);
+		addBlitzMugenAnimationComponent(mLeftAnimationBG, mSprites, mAnimations, -1);
 
 		mLeftAnimationFG = addBlitzEntity(Vector3D(160, 0, 2));
-		addBlitzMugenAnimationComponent(mLeftAnimationFG, &mSprites, &mAnimations, -1);
+		addBlitzMugenAnimationComponent(mLeftAnimationFG, mSprites, mAnimations, -1);
 
 		mRightAnimationBG = addBlitzEntity(Vector3D(160, 0, 1));
-		addBlitzMugenAnimationComponent(mRightAnimationBG, &mSprites, &mAnimations, -1);
+		addBlitzMugenAnimationComponent(mRightAnimationBG, mSprites, mAnimations, -1);
 
 		mRightAnimationFG = addBlitzEntity(Vector3D(160, 0, 2));
-		addBlitzMugenAnimationComponent(mRightAnimationFG, &mSprites, &mAnimations, -1);
+		addBlitzMugenAnimationComponent(mRightAnimationFG, mSprites, mAnimations, -1);
 
 		mTextId = addMugenTextMugenStyle(" ", Vector3D(40, 200, 3), Vector3DI(1, 7, 1));
 		setMugenTextScale(mTextId, 1.0);
@@ -118,13 +110,10 @@ public:
 		loadInitialAnimations();
 	}
 
-	int currentLoadedVoiceSoundEffectId = -1;
-	int currentPlayingVoiceSoundEffectId = -1;
 	void playVoiceClip()
 	{
 		if (isOnDreamcast()) return;
-		stopAllSoundEffects();
-		tryPlayMugenSound(&mSounds, 1, mRightSelected);
+		tryPlayMugenSound(mSounds, 1, mRightSelected);
 	}
 
 	void  loadInitialAnimations()
@@ -147,7 +136,7 @@ public:
 		if (!isGameInitialized && hasPressedMouseLeftFlank())
 		{
 			stopAllSoundEffects();
-			tryPlayMugenSound(&mSounds, 1, mRightSelected);
+			playVoiceClip();
 			isGameInitialized = true;
 		}
 		if (isFlippingPage)
@@ -205,18 +194,9 @@ public:
 		}
 
 
-		if (currentPlayingVoiceSoundEffectId != -1)
-		{
-			stopSoundEffect(currentPlayingVoiceSoundEffectId);
-			currentPlayingVoiceSoundEffectId = -1;
-		}
-		if (currentLoadedVoiceSoundEffectId != -1)
-		{
-
-			unloadSoundEffect(currentLoadedVoiceSoundEffectId);
-			currentLoadedVoiceSoundEffectId = -1;
-		}
-		tryPlayMugenSound(&mSoundsGeneral, 1, 0);
+		// The previous voice line is cut here instead of when the next one starts, so the page turn sound stays audible
+		stopAllSoundEffects();
+		tryPlayMugenSound(mSoundsGeneral, 1, 0);
 
 
 		mRightSelected++;
@@ -320,21 +300,25 @@ public:
 
 	void setTextActive()
 	{
-		auto& bookPart = mActiveBookText->mParts[mRightSelected];
+		auto pageText = getPageText(mRightSelected);
 		playVoiceClip();
-		if (bookPart.text == "end" || bookPart.text == "title") return;
+		if (!strcmp(pageText, "end") || !strcmp(pageText, "title")) return;
 		if (gBookScreenData.mBookName == "outro" && mRightSelected == 3)
 		{
-			bookPart.text += getSpeedRunString();
+			auto text = std::string(pageText) + getSpeedRunString();
+			changeMugenText(mTextId, text.c_str());
+		}
+		else
+		{
+			changeMugenText(mTextId, pageText);
 		}
-		changeMugenText(mTextId, bookPart.text.c_str());
 		setMugenTextBuildup(mTextId, 1);
 		setMugenTextVisibility(mTextId, true);
 	}
 
 	int isFinalPage()
 	{
-		return mRightSelected == mActiveBookText->mParts.size() - 1;
+		return mRightSelected == getPageAmount() - 1;
 	}
 
 	void gotoVNScreen()
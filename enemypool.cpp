@@ -0,0 +1,38 @@
+#include "enemypool.h"
+
+void EnemyPool::add(int entityId, const Vector2D& position, const Vector2D& target, double speed, GameValue life, int animationNo, int attackCollisionId, int passiveCollisionId, bool isChasingPlayer)
+{
+    entityIds.push_back(entityId);
+    targets.push_back(target);
+    speeds.push_back(speed);
+    rows.push_back(-1);
+    lifes.push_back(life);
+    auto state = makeActorState(entityId, animationNo);
+    state.mPosition = Vector3D(position.x, position.y, 0);
+    states.push_back(state);
+    attackCollisionIds.push_back(attackCollisionId);
+    passiveCollisionIds.push_back(passiveCollisionId);
+    isToBeDeleted.push_back(0);
+    isChasing.push_back(isChasingPlayer);
+}
+
+template<typename T>
+static void swapAndPop(std::vector<T>& v, size_t i)
+{
+    v[i] = v.back();
+    v.pop_back();
+}
+
+void EnemyPool::removeAt(size_t i)
+{
+    swapAndPop(entityIds, i);
+    swapAndPop(targets, i);
+    swapAndPop(speeds, i);
+    swapAndPop(rows, i);
+    swapAndPop(lifes, i);
+    swapAndPop(states, i);
+    swapAndPop(attackCollisionIds, i);
+    swapAndPop(passiveCollisionIds, i);
+    swapAndPop(isToBeDeleted, i);
+    swapAndPop(isChasing, i);
+}
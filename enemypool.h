@@ -0,0 +1,28 @@
+#pragma once
+
+#include <prism/blitz.h>
+
+#include "actorstate.h"
+#include "gamevalue.h"
+
+// Structure of arrays over the live enemies of a wave. Removal swaps the last enemy into the freed index, so indices stay dense.
+// Position and scale live in the ActorState, there is no second copy of them here.
+struct EnemyPool
+{
+    std::vector<int> entityIds;
+    std::vector<Vector2D> targets;
+    std::vector<double> speeds;
+    std::vector<int> rows;
+    std::vector<GameValue> lifes;
+    std::vector<ActorState> states;
+    std::vector<int> attackCollisionIds;
+    std::vector<int> passiveCollisionIds;
+    std::vector<uint8_t> isToBeDeleted;
+    std::vector<uint8_t> isChasing;
+
+    size_t size() const { return entityIds.size(); }
+    bool empty() const { return entityIds.empty(); }
+
+    void add(int entityId, const Vector2D& position, const Vector2D& target, double speed, GameValue life, int animationNo, int attackCollisionId, int passiveCollisionId, bool isChasingPlayer);
+    void removeAt(size_t i);
+};
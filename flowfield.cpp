@@ -0,0 +1,98 @@
+#include "flowfield.h"
+
+#include <climits>
+
+FlowField::FlowField(double minX, double minY, double maxX, double maxY, double cellSize)
+    : mMinX(minX)
+    , mMinY(minY)
+    , mCellSize(cellSize)
+{
+    mColumns = max(1, int(ceil((maxX - minX) / cellSize)));
+    mRows = max(1, int(ceil((maxY - minY) / cellSize)));
+    mDistances.resize(mColumns * mRows);
+    mDirections.resize(mColumns * mRows);
+    mQueue.reserve(mColumns * mRows);
+}
+
+int FlowField::getColumn(double x) const
+{
+    return std::clamp(int((x - mMinX) / mCellSize), 0, mColumns - 1);
+}
+
+int FlowField::getRow(double y) const
+{
+    return std::clamp(int((y - mMinY) / mCellSize), 0, mRows - 1);
+}
+
+int FlowField::getCellIndex(const Vector2D& pos) const
+{
+    return getRow(pos.y) * mColumns + getColumn(pos.x);
+}
+
+// Only rebuilds when the goal moves to another cell, so a standing or slowly walking player costs nothing
+bool FlowField::setGoal(const Vector2D& pos)
+{
+    int goalCell = getCellIndex(pos);
+    if (goalCell == mGoalCell) return false;
+    mGoalCell = goalCell;
+    rebuild();
+    return true;
+}
+
+Vector2D FlowField::sample(const Vector2D& pos) const
+{
+    if (mGoalCell == -1) return Vector2D(0, 0);
+    return mDirections[getCellIndex(pos)];
+}
+
+void FlowField::rebuild()
+{
+    std::fill(mDistances.begin(), mDistances.end(), INT_MAX);
+    mQueue.clear();
+    mDistances[mGoalCell] = 0;
+    mQueue.push_back(mGoalCell);
+    for (size_t i = 0; i < mQueue.size(); i++)
+    {
+        int cell = mQueue[i];
+        int row = cell / mColumns;
+        int column = cell % mColumns;
+        static const int NEIGHBOURS[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+        for (auto& neighbour : NEIGHBOURS)
+        {
+            int nextColumn = column + neighbour[0];
+            int nextRow = row + neighbour[1];
+            if (nextColumn < 0 || nextColumn >= mColumns || nextRow < 0 || nextRow >= mRows) continue;
+            int next = nextRow * mColumns + nextColumn;
+            if (mDistances[next] != INT_MAX) continue;
+            mDistances[next] = mDistances[cell] + 1;
+            mQueue.push_back(next);
+        }
+    }
+
+    // Looking at all eight neighbours lets the field point diagonally instead of walking staircases
+    for (int row = 0; row < mRows; row++)
+    {
+        for (int column = 0; column < mColumns; column++)
+        {
+            int cell = row * mColumns + column;
+            int bestDistance = mDistances[cell];
+            Vector2D bestDirection(0, 0);
+            for (int y = -1; y <= 1; y++)
+            {
+                for (int x = -1; x <= 1; x++)
+                {
+                    int nextColumn = column + x;
+                    int nextRow = row + y;
+                    if (nextColumn < 0 || nextColumn >= mColumns || nextRow < 0 || nextRow >= mRows) continue;
+                    int distance = mDistances[nextRow * mColumns + nextColumn];
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        bestDirection = vecNormalize(Vector2D(x, y));
+                    }
+                }
+            }
+            mDirections[cell] = bestDirection;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <prism/blitz.h>
+
+// Coarse breadth first field over the play area, every cell stores the direction of its next step toward the goal cell
+class FlowField
+{
+public:
+    FlowField(double minX, double minY, double maxX, double maxY, double cellSize);
+
+    bool setGoal(const Vector2D& pos);
+    Vector2D sample(const Vector2D& pos) const;
+
+private:
+    void rebuild();
+
+    int getCellIndex(const Vector2D& pos) const;
+    int getColumn(double x) const;
+    int getRow(double y) const;
+
+    double mMinX;
+    double mMinY;
+    double mCellSize;
+    int mColumns;
+    int mRows;
+    int mGoalCell = -1;
+    std::vector<int> mDistances;
+    std::vector<Vector2D> mDirections;
+    std::vector<int> mQueue;
+};
@@ -0,0 +1,17 @@
+#include "gameinput.h"
+
+#include <prism/input.h>
+
+GameInput sampleLiveGameInput()
+{
+    GameInput input = 0;
+    if (hasPressedLeft()) input |= GAME_INPUT_LEFT;
+    if (hasPressedRight()) input |= GAME_INPUT_RIGHT;
+    if (hasPressedUp()) input |= GAME_INPUT_UP;
+    if (hasPressedDown()) input |= GAME_INPUT_DOWN;
+    if (hasPressedAFlank()) input |= GAME_INPUT_A_FLANK;
+    if (hasPressedStartFlank()) input |= GAME_INPUT_START_FLANK;
+    if (hasPressedUpFlank()) input |= GAME_INPUT_UP_FLANK;
+    if (hasPressedDownFlank()) input |= GAME_INPUT_DOWN_FLANK;
+    return input;
+}
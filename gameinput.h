@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+#define GAME_INPUT_LEFT (1 << 0)
+#define GAME_INPUT_RIGHT (1 << 1)
+#define GAME_INPUT_UP (1 << 2)
+#define GAME_INPUT_DOWN (1 << 3)
+#define GAME_INPUT_A_FLANK (1 << 4)
+#define GAME_INPUT_START_FLANK (1 << 5)
+#define GAME_INPUT_UP_FLANK (1 << 6)
+#define GAME_INPUT_DOWN_FLANK (1 << 7)
+
+typedef uint8_t GameInput;
+
+GameInput sampleLiveGameInput();
@@ -1,50 +1,143 @@
 #include "gamescreen.h"
 
+#include <climits>
+#include <chrono>
 #include <prism/numberpopuphandler.h>
+#include <prism/soundeffect.h>
 
 #include "bookscreen.h"
+#include "assetcache.h"
+#include "spatialgrid.h"
+#include "enemypool.h"
+#include "flowfield.h"
+#include "numberformat.h"
+#include "gamevalue.h"
+#include "wavetable.h"
+#include "actorstate.h"
+#include "musicstream.h"
+#include "gameinput.h"
+#include "headless.h"
+#include "replay.h"
+#include "profiler.h"
+#include "jobsystem.h"
 
 static struct 
 {
     int mLevel = 0;
-    int mPlayerLoveCount;
+    GameValue mPlayerLoveCount;
     int mStrengthLevel;
     int mSpeedLevel;
     int mGameTicks;
+    uint32_t mRandomState = 1;
 } gGameScreenData;
 
+// Draw scale for every screen row of the play area, actors take it from the row their feet are on
+static constexpr int PLAY_AREA_ROW_START = 76;
+static constexpr int PLAY_AREA_ROW_END = 171;
+static constexpr int PLAY_AREA_ROW_AMOUNT = PLAY_AREA_ROW_END - PLAY_AREA_ROW_START + 1;
+
+struct ScaleTable
+{
+    double rows[PLAY_AREA_ROW_AMOUNT];
+
+    constexpr ScaleTable() : rows() {
+        for (int i = 0; i < PLAY_AREA_ROW_AMOUNT; i++)
+        {
+            double t = i / double(PLAY_AREA_ROW_END - PLAY_AREA_ROW_START);
+            rows[i] = 0.5 + 0.5f * t;
+        }
+    }
+};
+static constexpr ScaleTable gScaleTable;
+
+static double randomGameValue(double minValue, double maxValue)
+{
+    // xorshift32, owned by the game state so recorded runs replay with the same enemy placement
+    auto& x = gGameScreenData.mRandomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return minValue + (maxValue - minValue) * (x / double(UINT32_MAX));
+}
+
 class GameScreen
 {
 public:
 
     double sfxVol = 0.2;
 
-    std::vector<int> enemyStrengths = { 100, 10000, 1000000 };
-    std::vector<int> enemyLifes = { 1000, 100000, 10000000 };
-    std::vector<int> playerStrengths = { 1, 100, 10000, 1000000 };
-    std::vector<int> playerLifes = { 1, 1000, 100000, 10000000 };
-    std::vector<int> loveGains = { 10, 1000, 100000 };
+    std::vector<GameValue> playerStrengths = { 1, 100, 10000, 1000000 };
+    std::vector<GameValue> playerLifes = { 1, 1000, 100000, 10000000 };
 
     GameScreen() {
         instantiateActor(getPrismNumberPopupHandler());
+        loadFiles();
         load();
         //activateCollisionHandlerDebugMode();
     }
+    ~GameScreen() {
+        unloadEnemies();
+        unloadFiles();
+    }
 
-    MugenSpriteFile mSprites;
-    MugenAnimations mAnimations;
-    MugenSounds mSounds;
+    MugenSpriteFile* mSprites;
+    MugenAnimations* mAnimations;
+    MugenSounds* mSounds;
 
     void loadFiles() {
-        mSprites = loadMugenSpriteFileWithoutPalette("game/GAME.sff");
-        mAnimations = loadMugenAnimationFile("game/GAME.air");
-        mSounds = loadMugenSoundFile("game/GAME.snd");
+        mSprites = acquireCachedMugenSpriteFile("game/GAME.sff");
+        mAnimations = acquireCachedMugenAnimations("game/GAME.air");
+        mSounds = acquireCachedMugenSounds("game/GAME.snd");
+        if (!isSilent())
+        {
+            mStingerSounds = acquireCachedMugenSounds(STINGER_SOUND_PATH);
+        }
+    }
+
+    void unloadFiles() {
+        releaseCachedAsset("game/GAME.sff");
+        releaseCachedAsset("game/GAME.air");
+        releaseCachedAsset("game/GAME.snd");
+        if (mWinningSprites)
+        {
+            releaseCachedAsset(WINNING_SPRITE_PATH);
+        }
+        if (mUpgradeSprites)
+        {
+            releaseCachedAsset(UPGRADE_SPRITE_PATH);
+        }
+        if (mStingerSounds)
+        {
+            releaseCachedAsset(STINGER_SOUND_PATH);
+        }
+    }
+
+    // Full screen art, split per screen so each one only loads what it shows, fetched once combat has stopped
+    static constexpr const char* WINNING_SPRITE_PATH = "game/WINNING.sff";
+    static constexpr const char* UPGRADE_SPRITE_PATH = "game/UPGRADE.sff";
+    MugenSpriteFile* mWinningSprites = nullptr;
+    MugenSpriteFile* mUpgradeSprites = nullptr;
+    MugenSpriteFile* getWinningSprites() {
+        if (!mWinningSprites)
+        {
+            mWinningSprites = acquireCachedMugenSpriteFile(WINNING_SPRITE_PATH);
+        }
+        return mWinningSprites;
+    }
+    MugenSpriteFile* getUpgradeSprites() {
+        if (!mUpgradeSprites)
+        {
+            mUpgradeSprites = acquireCachedMugenSpriteFile(UPGRADE_SPRITE_PATH);
+        }
+        return mUpgradeSprites;
     }
 
     void load() {
-        loadFiles();
         loadGame();
-        streamMusicFile("game/GAME.ogg");
+        if (!isSilent())
+        {
+            startMusicStream("game/GAME.ogg");
+        }
     }
 
     void loadGame() {
@@ -53,19 +146,187 @@ public:
         loadWaveStart();
         loadPlayer();
         loadEnemies();
+        loadBlood();
         loadUI();
-        loadWinning();
         loadUpgradeScreen();
+        loadProfilerOverlay();
     }
 
     void update() {
-        updateBG();
-        updateWaveStart();
-        updatePlayer();
-        updateEnemies();
-        updateUI();
-        updateWinning();
-        updateUpgradeScreen();
+        startProfilerFrame();
+        updateInput();
+        reportCollisionStats();
+        {
+            PROFILE_SCOPE("updateBG");
+            updateBG();
+        }
+        {
+            PROFILE_SCOPE("updateWaveStart");
+            updateWaveStart();
+        }
+        {
+            PROFILE_SCOPE("updatePlayer");
+            updatePlayer();
+        }
+        {
+            PROFILE_SCOPE("updateEnemies");
+            updateEnemies();
+        }
+        {
+            PROFILE_SCOPE("updateBlood");
+            updateBlood();
+        }
+        {
+            PROFILE_SCOPE("updateLovePopups");
+            updateLovePopups();
+        }
+        {
+            PROFILE_SCOPE("updateUI");
+            updateUI();
+        }
+        {
+            PROFILE_SCOPE("updateWinning");
+            updateWinning();
+        }
+        {
+            PROFILE_SCOPE("updateUpgradeScreen");
+            updateUpgradeScreen();
+        }
+        flushSoundQueue();
+        updateHeadless();
+        updateReplayHash();
+        updateProfilerOverlay();
+        finishProfilerFrame();
+    }
+
+    // INPUT
+    GameInput input = 0;
+    void updateInput() {
+        if (isPlayingReplay())
+        {
+            input = getReplayInput();
+            return;
+        }
+        input = isHeadless() ? getHeadlessBotInput() : sampleLiveGameInput();
+        recordReplayInput(input);
+    }
+    bool hasInput(GameInput flag) {
+        return (input & flag) != 0;
+    }
+
+    // SOUND
+    bool isSilent() {
+        return isHeadless() || isPlayingReplay();
+    }
+    // Requests are collected over the frame and mixed in one batch, so a whole wave dying at once costs a handful of voices
+    static constexpr int MAX_SOUNDS_PER_FRAME = 4;
+    static constexpr int MAX_ACTIVE_SOUND_VOICES = 8;
+    struct QueuedSound {
+        int group;
+        int item;
+        double volume;
+        int priority;
+    };
+    struct PlayedSound {
+        int group;
+        int item;
+        int frame;
+        int priority;
+        int channel;
+    };
+    QueuedSound queuedSounds[MAX_SOUNDS_PER_FRAME];
+    int queuedSoundAmount = 0;
+    PlayedSound playedSounds[MAX_ACTIVE_SOUND_VOICES];
+    int playedSoundAmount = 0;
+    int soundFrame = 0;
+
+    int getSoundPriority(int group, int item) {
+        if (group == 100) return 3; // stingers
+        if (group == 2) return 2; // upgrade menu
+        if (group == 1 && item == 3) return 1; // enemy death
+        return 0;
+    }
+    int getSoundCooldownFrames(int group) {
+        return group == 1 ? 3 : 0;
+    }
+    bool isSoundCoolingDown(int group, int item) {
+        for (int i = 0; i < playedSoundAmount; i++)
+        {
+            auto& played = playedSounds[i];
+            if (played.group == group && played.item == item && soundFrame - played.frame < getSoundCooldownFrames(group)) return true;
+        }
+        return false;
+    }
+    void playSound(int group, int item, double volume) {
+        if (isSilent()) return;
+        for (int i = 0; i < queuedSoundAmount; i++)
+        {
+            auto& queued = queuedSounds[i];
+            if (queued.group == group && queued.item == item)
+            {
+                queued.volume = max(queued.volume, volume);
+                return;
+            }
+        }
+        if (isSoundCoolingDown(group, item)) return;
+
+        QueuedSound sound = { group, item, volume, getSoundPriority(group, item) };
+        if (queuedSoundAmount < MAX_SOUNDS_PER_FRAME)
+        {
+            queuedSounds[queuedSoundAmount++] = sound;
+            return;
+        }
+        int lowest = 0;
+        for (int i = 1; i < queuedSoundAmount; i++)
+        {
+            if (queuedSounds[i].priority < queuedSounds[lowest].priority) lowest = i;
+        }
+        if (queuedSounds[lowest].priority < sound.priority) queuedSounds[lowest] = sound;
+    }
+    void removeFinishedSoundVoices() {
+        int kept = 0;
+        for (int i = 0; i < playedSoundAmount; i++)
+        {
+            auto channel = playedSounds[i].channel;
+            if (channel != -1 && isSoundEffectPlayingOnChannel(channel)) playedSounds[kept++] = playedSounds[i];
+        }
+        playedSoundAmount = kept;
+    }
+    // Returns the voice slot for the sound, stealing stops the oldest lower priority voice on its channel
+    int claimSoundVoice(const QueuedSound& sound) {
+        if (playedSoundAmount < MAX_ACTIVE_SOUND_VOICES)
+        {
+            return playedSoundAmount++;
+        }
+        int victim = -1;
+        for (int i = 0; i < playedSoundAmount; i++)
+        {
+            if (playedSounds[i].priority >= sound.priority) continue;
+            if (victim == -1 || playedSounds[i].frame < playedSounds[victim].frame) victim = i;
+        }
+        if (victim == -1) return -1;
+        stopSoundEffect(playedSounds[victim].channel);
+        return victim;
+    }
+    // The win and game over stingers are kept in their own mono 22k bank, resident next to GAME.snd
+    static constexpr int STINGER_SOUND_GROUP = 100;
+    static constexpr const char* STINGER_SOUND_PATH = "game/STINGERS.snd";
+    MugenSounds* mStingerSounds = nullptr;
+    MugenSounds* getSoundBank(int group) {
+        return group == STINGER_SOUND_GROUP ? mStingerSounds : mSounds;
+    }
+    void flushSoundQueue() {
+        removeFinishedSoundVoices();
+        for (int i = 0; i < queuedSoundAmount; i++)
+        {
+            auto& sound = queuedSounds[i];
+            int slot = claimSoundVoice(sound);
+            if (slot == -1) continue;
+            int channel = tryPlayMugenSoundAdvanced(getSoundBank(sound.group), sound.group, sound.item, sound.volume);
+            playedSounds[slot] = { sound.group, sound.item, soundFrame, sound.priority, channel };
+        }
+        queuedSoundAmount = 0;
+        soundFrame++;
     }
 
     // START UI
@@ -75,7 +336,7 @@ public:
     bool isWaveStartActive = false;
     int waveStartTicks = 0;
     void loadWaveStart() {
-        waveStartUI = addMugenAnimation(getMugenAnimation(&mAnimations, 90), &mSprites, Vector3D(0, 0, 40));
+        waveStartUI = addMugenAnimation(getMugenAnimation(mAnimations, 90), mSprites, Vector3D(0, 0, 40));
         setMugenAnimationVisibility(waveStartUI, 0);
         std::string s = std::string("WAVE ") + std::to_string(gGameScreenData.mLevel + 1);
         waveStartTextId = addMugenTextMugenStyle(s.c_str(), Vector3D(115, 230, 40), Vector3DI(2, 0, 1));
@@ -96,8 +357,9 @@ public:
     void updateWaveStartActive() {
         if (!isWaveStartActive) return;
 
+        updateEnemyReserve();
         waveStartTicks++;
-        if (waveStartTicks > 180 || hasPressedStartFlank())
+        if (waveStartTicks > 180 || hasInput(GAME_INPUT_START_FLANK))
         {
             setMugenAnimationVisibility(lifebarBG, 1);
             setMugenAnimationVisibility(lifebarFG, 1);
@@ -124,15 +386,25 @@ public:
         addCollisionHandlerCheck(playerCollisionList, enemyAttackCollisionList);
     }
 
-    double playerAreaStart = 76;
-    double playerAreaEnd = 171;
+    double playerAreaStart = PLAY_AREA_ROW_START;
+    double playerAreaEnd = PLAY_AREA_ROW_END;
+    // Placed just in front of the actor it belongs to, always larger than the tie-break below
+    static constexpr double DEPTH_FRONT_OFFSET = 0.001;
+    // Keeps actors at the same y in a fixed order instead of whatever order blitz happens to sort them in
+    static constexpr double DEPTH_TIE_BREAK_STEP = 1e-6;
+    int yToRow(double y) {
+        return max(0, min(PLAY_AREA_ROW_AMOUNT - 1, int(y) - PLAY_AREA_ROW_START));
+    }
+    // Continuous in y, only the scale is quantised to rows
     double yToZ(double y) {
         double t = (y - playerAreaStart) / (playerAreaEnd - playerAreaStart);
         return 10.f + 10.f * t;
     }
+    double yToZ(double y, int entityId) {
+        return yToZ(y) + DEPTH_TIE_BREAK_STEP * (entityId % 256);
+    }
     double yToScale(double y) {
-        double t = (y - playerAreaStart) / (playerAreaEnd - playerAreaStart);
-        return 0.5 + 0.5f * t;
+        return gScaleTable.rows[yToRow(y)];
     }
 
     // BG
@@ -140,9 +412,9 @@ public:
     int girlEntity;
     void loadBG() {
         bgEntity = addBlitzEntity(Vector3D(0, 0, 1));
-        addBlitzMugenAnimationComponent(bgEntity, &mSprites, &mAnimations, 1);
+        addBlitzMugenAnimationComponent(bgEntity, mSprites, mAnimations, 1);
         girlEntity = addBlitzEntity(Vector3D(99, 47, 2));
-        addBlitzMugenAnimationComponent(girlEntity, &mSprites, &mAnimations, 5);
+        addBlitzMugenAnimationComponent(girlEntity, mSprites, mAnimations, 5);
     }
     void updateBG() {}
 
@@ -150,97 +422,109 @@ public:
     int playerEntity;
     int playerAttackCollisionId;
     int playerPassiveCollisionId;
-    int playerStrength = 1;
+    GameValue playerStrength = 1;
     void loadPlayer() {
         playerEntity = addBlitzEntity(Vector3D(100, 100, 10));
-        addBlitzMugenAnimationComponent(playerEntity, &mSprites, &mAnimations, 10);
+        addBlitzMugenAnimationComponent(playerEntity, mSprites, mAnimations, 10);
         playerAttackCollisionId = addBlitzCollisionAttackMugen(playerEntity, playerAttackCollisionList);
         playerPassiveCollisionId = addBlitzCollisionPassiveMugen(playerEntity, playerCollisionList);
         playerStrength = playerStrengths[min(gGameScreenData.mStrengthLevel, int(playerStrengths.size() - 1))];
         maxPlayerLife = playerLifes[min(gGameScreenData.mSpeedLevel, int(playerLifes.size() - 1))];
         playerLife = maxPlayerLife;
 
-        auto playerPosRef = getBlitzEntityPositionReference(playerEntity);
-        playerPosRef->z = yToZ(playerPosRef->y);
-        setBlitzMugenAnimationBaseDrawScale(playerEntity, yToScale(playerPosRef->y));
+        playerState = makeActorState(playerEntity, 10);
+        snapshotActorStates(&playerState, 1);
+        updatePlayerDepth();
+        writeBackActorStates(&playerState, 1);
+    }
+    ActorState playerState;
+    int playerRow = -1;
+    void updatePlayerDepth() {
+        auto pos = playerState.mPosition;
+        int row = yToRow(pos.y);
+        pos.z = yToZ(pos.y, playerEntity);
+        setActorPosition(&playerState, pos);
+        if (row == playerRow) return;
+        playerRow = row;
+        setActorScale(&playerState, gScaleTable.rows[row]);
     }
     void updatePlayer()
     {
         if (isUpgradeScreenActive || isWaveStartActive || isWinning) return;
         gGameScreenData.mGameTicks++;
+        snapshotActorStates(&playerState, 1);
         updatePlayerWalking();
         updatePlayerPunching();
         updatePlayerReturningToIdle();
         updatePlayerGettingHit();
         updatePlayerDying();
+        writeBackActorStates(&playerState, 1);
     }
 
     void updatePlayerReturningToIdle()
     {
-        auto animationNo = getBlitzMugenAnimationAnimationNumber(playerEntity);
+        auto animationNo = playerState.mAnimationNo;
         bool isBlocked = (animationNo == 12) || (animationNo == 13) || (animationNo == 14) || (animationNo == 15);
-        if (isBlocked && !getBlitzMugenAnimationRemainingAnimationTime(playerEntity))
+        if (isBlocked && !playerState.mRemainingAnimationTime)
         {
-            changeBlitzMugenAnimation(playerEntity, 10);
+            changeActorAnimation(&playerState, 10);
         }
     }
 
     double playerSpeed = 2.f;
     void updatePlayerWalking() {
-        auto animationNo = getBlitzMugenAnimationAnimationNumber(playerEntity);
+        auto animationNo = playerState.mAnimationNo;
         if (animationNo != 10 && animationNo != 11 && (animationNo != 12) && (animationNo != 13)) return;
 
         Vector2DI dir = Vector2DI(0, 0);
-        if (hasPressedLeft())
+        if (hasInput(GAME_INPUT_LEFT))
         {
             dir.x += -1;
-            setBlitzMugenAnimationFaceDirection(playerEntity, 0);
+            setActorFaceDirection(&playerState, 0);
         }
-        if (hasPressedRight())
+        if (hasInput(GAME_INPUT_RIGHT))
         {
             dir.x += 1;
-            setBlitzMugenAnimationFaceDirection(playerEntity, 1);
+            setActorFaceDirection(&playerState, 1);
         }
-        if (hasPressedUp())
+        if (hasInput(GAME_INPUT_UP))
         {
             dir.y += -1;
         }
-        if (hasPressedDown())
+        if (hasInput(GAME_INPUT_DOWN))
         {
             dir.y += 1;
         }
         if (!dir.x && !dir.y)
         {
-            if (getBlitzMugenAnimationAnimationNumber(playerEntity) == 11)
+            if (playerState.mAnimationNo == 11)
             {
-                changeBlitzMugenAnimation(playerEntity, 10);
+                changeActorAnimation(&playerState, 10);
             }
             return;
         }
-        changeBlitzMugenAnimationIfDifferent(playerEntity, 11);
+        changeActorAnimationIfDifferent(&playerState, 11);
 
         auto dirScaled = vecNormalize(dir) * playerSpeed;
-        auto playerPosRef = getBlitzEntityPositionReference(playerEntity);
-        *playerPosRef = *playerPosRef + dirScaled;
-        *playerPosRef = clampPositionToGeoRectangle(*playerPosRef, GeoRectangle2D(0, playerAreaStart, 320, playerAreaEnd - playerAreaStart));
-        playerPosRef->z = yToZ(playerPosRef->y);
-        setBlitzMugenAnimationBaseDrawScale(playerEntity, yToScale(playerPosRef->y));
+        auto pos = playerState.mPosition + dirScaled;
+        setActorPosition(&playerState, clampPositionToGeoRectangle(pos, GeoRectangle2D(0, playerAreaStart, 320, playerAreaEnd - playerAreaStart)));
+        updatePlayerDepth();
     }
     void updatePlayerPunching() {
-        auto animationNo = getBlitzMugenAnimationAnimationNumber(playerEntity);
+        auto animationNo = playerState.mAnimationNo;
         bool isBlocked = (animationNo == 16);
         if (isBlocked) return;
 
-        if (hasPressedAFlank())
+        if (hasInput(GAME_INPUT_A_FLANK))
         {
-            int newAnimation = (getBlitzMugenAnimationAnimationNumber(playerEntity) == 12) ? 13 : 12;
-            changeBlitzMugenAnimation(playerEntity, newAnimation);
-            tryPlayMugenSoundAdvanced(&mSounds, 1, 4, sfxVol / 2.f);
+            int newAnimation = (playerState.mAnimationNo == 12) ? 13 : 12;
+            changeActorAnimation(&playerState, newAnimation);
+            playSound(1, 4, sfxVol / 2.f);
         }
     }
 
-    int maxPlayerLife = 10;
-    int playerLife = 1000;
+    GameValue maxPlayerLife = 10;
+    GameValue playerLife = 1000;
     int invincibilityFrames = 0;
     void updatePlayerGettingHit() {
         if (invincibilityFrames)
@@ -255,15 +539,15 @@ public:
 
         if (hasBlitzCollidedThisFrame(playerEntity, playerPassiveCollisionId))
         {
-            int animationNo = getBlitzMugenAnimationAnimationNumber(playerEntity) == 14 ? 15 : 14;
-            changeBlitzMugenAnimation(playerEntity, animationNo);
-            tryPlayMugenSoundAdvanced(&mSounds, 1, 1, sfxVol);
-            int strength = enemyStrengths[min(gGameScreenData.mLevel, int(enemyStrengths.size() - 1))];
-            playerLife = max(0, playerLife - strength);
-            auto playerPos = getBlitzEntityPosition(playerEntity).xy();
+            enemyAttackStats.hits++;
+            int animationNo = playerState.mAnimationNo == 14 ? 15 : 14;
+            changeActorAnimation(&playerState, animationNo);
+            playSound(1, 1, sfxVol);
+            playerLife = subtractGameValue(playerLife, wave->mStrength);
+            auto playerPos = playerState.mPosition.xy();
             if (gGameScreenData.mSpeedLevel - gGameScreenData.mLevel < 2)
             {
-                addBloodSplatter(playerPos + Vector2D(0, 10), playerPos.y + 0.001, (*getBlitzMugenAnimationBaseScaleReference(playerEntity)), !getBlitzMugenAnimationIsFacingRight(playerEntity));
+                addBloodSplatter(playerPos + Vector2D(0, 10), playerPos.y, playerState.mScale, !playerState.mIsFacingRight);
             }
             invincibilityFrames = 60;
             setBlitzMugenAnimationTransparency(playerEntity, 0.7);
@@ -271,259 +555,479 @@ public:
     }
     void updatePlayerDying() {
         if (playerLife) return;
+        getUpgradeSprites();
 
-        if (getBlitzMugenAnimationAnimationNumber(playerEntity) != 16)
+        if (playerState.mAnimationNo != 16)
         {
-            tryPlayMugenSoundAdvanced(&mSounds, 1, 2, sfxVol);
+            playSound(1, 2, sfxVol);
         }
-        changeBlitzMugenAnimationIfDifferent(playerEntity, 16);
+        changeActorAnimationIfDifferent(&playerState, 16);
     }
 
     // Enemies
-    struct Enemy
-    {
-        int entityId;
-        Vector2D target;
-        double speed;
-        int attackCollisionId;
-        int passiveCollisionId;
-        int life;
-        bool isToBeDeleted;
-    };
-    std::map<int, Enemy> mEnemies;
+    EnemyPool mEnemies;
+    SpatialGrid mEnemyGrid = SpatialGrid(0, playerAreaStart, 320, playerAreaEnd, 24);
+    // Shared by every enemy chasing the player, so following the player costs one lookup per enemy however big the wave is
+    static constexpr double PLAYER_FLOW_FIELD_CELL_SIZE = 16.0;
+    FlowField mPlayerFlowField = FlowField(0, playerAreaStart, 320, playerAreaEnd, PLAYER_FLOW_FIELD_CELL_SIZE);
 
+    WaveTable mWaveTable;
+    bool hasWaveTable = false;
+    const WaveDefinition* wave;
     void loadEnemies() {
+        loadWaveTable(&mWaveTable, "game/WAVES.bin");
+        hasWaveTable = true;
+        wave = getWaveDefinition(&mWaveTable, gGameScreenData.mLevel);
         loadEnemySpawning();
     }
+    void unloadEnemies() {
+        if (!hasWaveTable) return;
+        unloadWaveTable(&mWaveTable);
+    }
+    int getWaveAmount() {
+        return int(mWaveTable.mWaveAmount);
+    }
+
+    // Enemies are streamed in batches over the wave instead of all being created on the first frame
+    int pendingSpawnAmount = 0;
+    int spawnTicks = 0;
     void loadEnemySpawning() {
-        int enemyCount = 10;
-        for (int i = 0; i < enemyCount; i++)
+        if (wave->mEnemyType)
         {
-            addSingleEnemy();
+            logWarningFormat("Unknown enemy type %d, using the waiters instead", wave->mEnemyType);
         }
+        pendingSpawnAmount = wave->mEnemyAmount;
+        spawnTicks = 0;
+    }
+    void updateEnemySpawning() {
+        if (!pendingSpawnAmount) return;
+        if (spawnTicks)
+        {
+            spawnTicks--;
+            return;
+        }
+        int amount = min(pendingSpawnAmount, int(wave->mSpawnBatch));
+        int spawnedAmount = wave->mEnemyAmount - pendingSpawnAmount;
+        for (int i = 0; i < amount; i++)
+        {
+            addSingleEnemy(spawnedAmount + i < wave->mChaserAmount);
+        }
+        pendingSpawnAmount -= amount;
+        spawnTicks = wave->mSpawnInterval;
+    }
+    // Entity creation is the expensive part of a spawn, so the wave's enemies are created hidden while the wave banner covers the screen
+    static constexpr int ENEMY_RESERVE_ENTITIES_PER_FRAME = 4;
+    static constexpr double ENEMY_RESERVE_BUDGET_MS = 2.0;
+    struct EnemyShell {
+        int entityId;
+        int attackCollisionId;
+        int passiveCollisionId;
+    };
+    std::vector<EnemyShell> enemyReserve;
+    EnemyShell createEnemyShell() {
+        EnemyShell shell;
+        shell.entityId = addBlitzEntity(Vector3D(0, 0, 0));
+        addBlitzMugenAnimationComponent(shell.entityId, mSprites, mAnimations, -1);
+        addBlitzCollisionComponent(shell.entityId);
+        shell.attackCollisionId = addBlitzCollisionAttackMugen(shell.entityId, enemyAttackCollisionList);
+        shell.passiveCollisionId = addBlitzCollisionPassiveMugen(shell.entityId, enemyCollisionList);
+        return shell;
+    }
+    void updateEnemyReserve() {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ENEMY_RESERVE_ENTITIES_PER_FRAME && int(enemyReserve.size()) < pendingSpawnAmount; i++)
+        {
+            enemyReserve.push_back(createEnemyShell());
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() > ENEMY_RESERVE_BUDGET_MS) break;
+        }
+    }
+    EnemyShell takeEnemyShell() {
+        if (enemyReserve.empty()) return createEnemyShell();
+        auto shell = enemyReserve.back();
+        enemyReserve.pop_back();
+        return shell;
+    }
+    bool isWaveCleared() {
+        return mEnemies.empty() && !pendingSpawnAmount;
     }
-    bool hasPlayedEnemyHitSoundThisFrame = false;
     int enemyPunchCooldown = 0;
 
     void updateEnemies() {
         if (isUpgradeScreenActive || isWaveStartActive || isWinning) return;
+        updateEnemySpawning();
+        removeDeletedEnemies();
+        framePlayerPos = playerState.mPosition.xy();
+        mPlayerFlowField.setGoal(framePlayerPos);
         updateClosestEnemy();
 
-        hasPlayedEnemyHitSoundThisFrame = false;
+        snapshotActorStates(mEnemies.states.data(), mEnemies.size());
+        computeEnemyWalkSteps();
         if (enemyPunchCooldown) enemyPunchCooldown--;
-        auto it = mEnemies.begin();
-        while (it != mEnemies.end())
+        for (size_t i = 0; i < mEnemies.size(); i++)
         {
-            if (it->second.isToBeDeleted)
-            {
-                unloadSingleEnemy(it->second);
-                it = mEnemies.erase(it);
-            }
-            else
-            {
-                updateSingleEnemy(it->second);
-                it++;
-            }
+            updateSingleEnemy(i);
         }
+        writeBackActorStates(mEnemies.states.data(), mEnemies.size());
     }
-    int closestEnemyEntity = -1;
-    void updateClosestEnemy()
+    void removeDeletedEnemies()
     {
-        double closestEnemyDistance = INF;
-        auto playerPos = getBlitzEntityPosition(playerEntity).xy();
-
-        for (auto& eP : mEnemies)
+        size_t i = mEnemies.size();
+        while (i--)
         {
-            auto& e = eP.second;
-            auto pos = getBlitzEntityPosition(e.entityId).xy();
-            auto dist = vecLength(pos - playerPos);
-            if (dist < closestEnemyDistance)
+            if (mEnemies.isToBeDeleted[i])
             {
-                closestEnemyDistance = dist;
-                closestEnemyEntity = e.entityId;
+                unloadSingleEnemy(i);
+                mEnemyGrid.remove(int(i));
+                mEnemies.removeAt(i);
             }
         }
     }
+    Vector2D framePlayerPos;
+    // Pool index, only valid until the next removeDeletedEnemies
+    int closestEnemyIndex = -1;
+    void updateClosestEnemy()
+    {
+        closestEnemyIndex = mEnemies.empty() ? -1 : mEnemyGrid.findNearest(framePlayerPos);
+    }
 
     Vector2D generateRandomPositionInPlayArea()
     {
-        return Vector2D(randfrom(20, 300), randfrom(playerAreaStart, playerAreaEnd));
+        return Vector2D(randomGameValue(20, 300), randomGameValue(playerAreaStart, playerAreaEnd));
     }
 
-    void addSingleEnemy() {
+    void addSingleEnemy(bool isChasing) {
         Vector2D pos = generateRandomPositionInPlayArea();
-        int entityId = addBlitzEntity(pos.xyz(yToZ(pos.y)));
-        addBlitzMugenAnimationComponent(entityId, &mSprites, &mAnimations, 30);
-        addBlitzCollisionComponent(entityId);
-        auto attackCollisionId = addBlitzCollisionAttackMugen(entityId, enemyAttackCollisionList);
-        auto passiveCollisionId = addBlitzCollisionPassiveMugen(entityId, enemyCollisionList);
+        auto shell = takeEnemyShell();
+        int entityId = shell.entityId;
+        changeBlitzMugenAnimation(entityId, 30);
         auto target = generateRandomPositionInPlayArea();
-        double speed = 0.5f;
-        int life = enemyLifes[min(gGameScreenData.mLevel, int(enemyLifes.size() - 1))];
-        auto enemyPosReference = getBlitzEntityPositionReference(entityId);
-        enemyPosReference->z = yToZ(enemyPosReference->y);
-        setBlitzMugenAnimationBaseDrawScale(entityId, yToScale(enemyPosReference->y));
-
-        mEnemies[entityId] = Enemy{ entityId, target, speed, attackCollisionId, passiveCollisionId, life, false };
+        double speed = wave->mSpeed;
+        auto life = wave->mLife;
+        mEnemies.add(entityId, pos, target, speed, life, 30, shell.attackCollisionId, shell.passiveCollisionId, isChasing);
+        updateEnemyDepth(mEnemies.size() - 1, pos);
+        mEnemyGrid.insert(int(mEnemies.size() - 1), pos);
+    }
+    void unloadSingleEnemy(size_t i) {
+        removeBlitzEntity(mEnemies.entityIds[i]);
     }
-    void unloadSingleEnemy(Enemy& e) {
-        removeBlitzEntity(e.entityId);
+    void changeEnemyAnimation(size_t i, int animationNo) {
+        changeActorAnimation(&mEnemies.states[i], animationNo);
     }
-    void updateSingleEnemy(Enemy& e) {
-        updateSingleEnemyWalking(e);
-        updateSingleEnemyAttacking(e);
-        updateSingleEnemyReturningToIdle(e);
-        updateSingleEnemyTurningAround(e);
-        updateSingleEnemyGettingHit(e);
-        updateSingleEnemyDying(e);
+    void changeEnemyAnimationIfDifferent(size_t i, int animationNo) {
+        changeActorAnimationIfDifferent(&mEnemies.states[i], animationNo);
+    }
+    void updateSingleEnemy(size_t i) {
+        updateSingleEnemyWalking(i);
+        updateSingleEnemyAttacking(i);
+        updateSingleEnemyReturningToIdle(i);
+        updateSingleEnemyTurningAround(i);
+        updateSingleEnemyGettingHit(i);
+        updateSingleEnemyDying(i);
     }
 
-    void updateSingleEnemyTurningAround(Enemy& e)
+    void updateSingleEnemyTurningAround(size_t i)
     {
-        auto animationNo = getBlitzMugenAnimationAnimationNumber(e.entityId);
+        auto animationNo = mEnemies.states[i].mAnimationNo;
         if (animationNo != 30 && animationNo != 31) return;
-        auto playerPos = getBlitzEntityPosition(playerEntity).xy();
-        auto enemyPos = getBlitzEntityPosition(e.entityId).xy();
-        setBlitzMugenAnimationFaceDirection(e.entityId, int(enemyPos.x < playerPos.x));
+        setActorFaceDirection(&mEnemies.states[i], int(mEnemies.states[i].mPosition.x < framePlayerPos.x));
     }
 
-    void updateSingleEnemyReturningToIdle(Enemy& e)
+    void updateSingleEnemyReturningToIdle(size_t i)
     {
-        auto animationNo = getBlitzMugenAnimationAnimationNumber(e.entityId);
+        auto animationNo = mEnemies.states[i].mAnimationNo;
         bool isBlocked = (animationNo == 32) || (animationNo == 33) || (animationNo == 34) || (animationNo == 35);
-        if (isBlocked && !getBlitzMugenAnimationRemainingAnimationTime(e.entityId))
+        if (isBlocked && !mEnemies.states[i].mRemainingAnimationTime)
         {
-            changeBlitzMugenAnimation(e.entityId, 30);
+            changeEnemyAnimation(i, 30);
         }
     }
 
-    void updateSingleEnemyWalking(Enemy& e) {
-        if (e.entityId == closestEnemyEntity)
-        {
-            updateSingleEnemyWalkingClosest(e);
-        }
-        else
+    // Walking only reads the snapshot taken at the start of the frame, so it is computed on the job system.
+    // Everything touching blitz, the grid or the random state is applied afterwards in index order, which keeps runs identical for any thread count.
+    static constexpr size_t ENEMY_WALK_GRAIN_SIZE = 64;
+    // Enemies closer than the radius push each other apart so groups spread out instead of stacking on one spot
+    static constexpr double ENEMY_SEPARATION_RADIUS = 12.0;
+    static constexpr double ENEMY_SEPARATION_WEIGHT = 0.5;
+    struct EnemyWalkStep {
+        Vector2D position;
+        int animationNo;
+        bool hasReachedTarget;
+    };
+    std::vector<EnemyWalkStep> enemyWalkSteps;
+    void computeEnemyWalkSteps() {
+        enemyWalkSteps.resize(mEnemies.size());
+        runParallelFor(mEnemies.size(), ENEMY_WALK_GRAIN_SIZE, computeEnemyWalkStepRangeCB, this);
+    }
+    static void computeEnemyWalkStepRangeCB(void* caller, size_t begin, size_t end) {
+        auto screen = (GameScreen*)caller;
+        for (size_t i = begin; i < end; i++)
         {
-            updateSingleEnemyWalkingRegular(e);
+            screen->enemyWalkSteps[i] = screen->computeEnemyWalkStep(i);
         }
     }
-    void updateSingleEnemyWalkingClosest(Enemy& e) {
-        auto playerPos = getBlitzEntityPosition(playerEntity).xy();
-        auto enemyPos = getBlitzEntityPosition(e.entityId).xy();
-
-        bool isRightOfPlayer = (enemyPos.x > playerPos.x);
-        auto target = Vector2D(playerPos.x + isRightOfPlayer ? 15 : -15, playerPos.y);
-        updateSingleEnemyWalkingGeneral(e, target);
-    }
-    void updateSingleEnemyWalkingRegular(Enemy& e) {
-        updateSingleEnemyWalkingGeneral(e, e.target);
-    }
-    void updateSingleEnemyWalkingGeneral(Enemy& e, const Vector2D& target)
-    {
-        auto animationNo = getBlitzMugenAnimationAnimationNumber(e.entityId);
+    EnemyWalkStep computeEnemyWalkStep(size_t i) const {
+        EnemyWalkStep step = { mEnemies.states[i].mPosition.xy(), 0, false };
+        auto animationNo = mEnemies.states[i].mAnimationNo;
         bool isBlocked = (animationNo == 32) || (animationNo == 33) || (animationNo == 34) || (animationNo == 35) || (animationNo == 36);
-        if (isBlocked) return;
+        if (isBlocked) return step;
 
-        auto enemyPosReference = getBlitzEntityPositionReference(e.entityId);
+        auto& playerPos = framePlayerPos;
+        auto enemyPos = mEnemies.states[i].mPosition.xy();
+        auto speed = mEnemies.speeds[i];
 
-        auto dir = target - enemyPosReference->xy();
+        bool isChasing = mEnemies.isChasing[i] || int(i) == closestEnemyIndex;
+        auto target = mEnemies.targets[i];
+        if (isChasing)
+        {
+            bool isRightOfPlayer = (enemyPos.x > playerPos.x);
+            target = Vector2D(playerPos.x + (isRightOfPlayer ? 15 : -15), playerPos.y);
+        }
+
+        auto dir = target - enemyPos;
         auto dist = vecLength(dir);
-        if (dist < e.speed * 2)
+        if (dist < speed * 2)
+        {
+            step.animationNo = 30;
+            step.hasReachedTarget = true;
+            return step;
+        }
+
+        step.animationNo = 31;
+        auto steering = vecNormalize(dir);
+        if (isChasing && dist > PLAYER_FLOW_FIELD_CELL_SIZE * 2)
+        {
+            // Close to the player the coarse cells would make enemies zigzag around their spot, so they head there directly
+            auto flow = mPlayerFlowField.sample(enemyPos);
+            if (flow.x || flow.y) steering = flow;
+        }
+        auto velocity = steering + mEnemyGrid.getSeparation(int(i), enemyPos, ENEMY_SEPARATION_RADIUS) * ENEMY_SEPARATION_WEIGHT;
+        if (vecLength(velocity) > 1) velocity = vecNormalize(velocity);
+        step.position = clampPositionToGeoRectangle((enemyPos + velocity * speed).xyz(0), GeoRectangle2D(0, playerAreaStart, 320, playerAreaEnd - playerAreaStart)).xy();
+        return step;
+    }
+    void updateSingleEnemyWalking(size_t i) {
+        auto& step = enemyWalkSteps[i];
+        if (!step.animationNo) return;
+        changeEnemyAnimationIfDifferent(i, step.animationNo);
+        if (step.hasReachedTarget)
         {
-            changeBlitzMugenAnimationIfDifferent(e.entityId, 30);
-            e.target = generateRandomPositionInPlayArea();
+            mEnemies.targets[i] = generateRandomPositionInPlayArea();
             return;
         }
 
-        changeBlitzMugenAnimationIfDifferent(e.entityId, 31);
-        dir = vecNormalize(dir) * e.speed;
-        *enemyPosReference = *enemyPosReference + dir;
-        *enemyPosReference = clampPositionToGeoRectangle(*enemyPosReference, GeoRectangle2D(0, playerAreaStart, 320, playerAreaEnd - playerAreaStart));
-        enemyPosReference->z = yToZ(enemyPosReference->y);
-        setBlitzMugenAnimationBaseDrawScale(e.entityId, yToScale(enemyPosReference->y));
+        mEnemyGrid.move(int(i), step.position);
+        updateEnemyDepth(i, step.position);
+    }
+    void updateEnemyDepth(size_t i, const Vector2D& enemyPos) {
+        auto& state = mEnemies.states[i];
+        int row = yToRow(enemyPos.y);
+        setActorPosition(&state, enemyPos.xyz(yToZ(enemyPos.y, mEnemies.entityIds[i])));
+        if (row == mEnemies.rows[i]) return;
+        mEnemies.rows[i] = row;
+        setActorScale(&state, gScaleTable.rows[row]);
     }
 
-    void updateSingleEnemyAttacking(Enemy& e) {
-        if (e.entityId != closestEnemyEntity) return;
+    void updateSingleEnemyAttacking(size_t i) {
+        if (int(i) != closestEnemyIndex) return;
         if (enemyPunchCooldown) return;
-        auto animationNo = getBlitzMugenAnimationAnimationNumber(e.entityId);
+        auto animationNo = mEnemies.states[i].mAnimationNo;
         bool isBlocked = (animationNo == 32) || (animationNo == 33) || (animationNo == 34) || (animationNo == 35) || (animationNo == 36);
         if (isBlocked) return;
-        auto playerPos = getBlitzEntityPosition(playerEntity).xy();
-        auto enemyPos = getBlitzEntityPosition(e.entityId).xy();
+        auto& playerPos = framePlayerPos;
+        auto enemyPos = mEnemies.states[i].mPosition.xy();
         if (abs(playerPos.x - enemyPos.x) < 20 && abs(playerPos.y - enemyPos.y) < 10)
         {
-            int newAnimationNo = (getBlitzMugenAnimationAnimationNumber(e.entityId) == 32) ? 33 : 32;
-            changeBlitzMugenAnimation(e.entityId, newAnimationNo);
+            int newAnimationNo = (animationNo == 32) ? 33 : 32;
+            changeEnemyAnimation(i, newAnimationNo);
             enemyPunchCooldown = 60;
         }
     }
 
-    int bloodCounter = 0;
-    void addBloodSplatter(const Vector2D& pos, double y, double scale, bool isFacingRight)
-    {
-        int entityId = addBlitzEntity(pos.xyz(yToZ(y)));
-        addBlitzMugenAnimationComponent(entityId, &mSprites, &mAnimations, (bloodCounter % 2) ? 70 : 80);
-        setBlitzMugenAnimationBaseDrawScale(entityId, scale);
-        setBlitzMugenAnimationFaceDirection(entityId, isFacingRight);
-        setBlitzMugenAnimationNoLoop(entityId);
-        bloodCounter++;
+    void updateSingleEnemyGettingHit(size_t i) {
+        int entityId = mEnemies.entityIds[i];
+        if (hasBlitzCollidedThisFrame(entityId, mEnemies.passiveCollisionIds[i]))
+        {
+            playerAttackStats.hits++;
+            int animationNo = mEnemies.states[i].mAnimationNo == 34 ? 35 : 34;
+            changeEnemyAnimation(i, animationNo);
+            playSound(1, 0, sfxVol);
+            auto enemyPos = mEnemies.states[i].mPosition.xy();
+            if (gGameScreenData.mStrengthLevel > gGameScreenData.mLevel)
+            {
+                addBloodSplatter(enemyPos + Vector2D(0, 10), enemyPos.y, mEnemies.states[i].mScale, !mEnemies.states[i].mIsFacingRight);
+            }
+            mEnemies.lifes[i] = subtractGameValue(mEnemies.lifes[i], playerStrength);
+        }
     }
-
-    void updateSingleEnemyGettingHit(Enemy& e) {
-        if (hasBlitzCollidedThisFrame(e.entityId, e.passiveCollisionId))
+    bool isLastEnemyKilled() {
+        if (pendingSpawnAmount) return false;
+        for (auto& life : mEnemies.lifes)
+        {
+            if (life) return false;
+        }
+        return true;
+    }
+    void updateSingleEnemyDying(size_t i) {
+        if (!mEnemies.lifes[i])
         {
-            int animationNo = getBlitzMugenAnimationAnimationNumber(e.entityId) == 34 ? 35 : 34;
-            changeBlitzMugenAnimation(e.entityId, animationNo);
-            if (!hasPlayedEnemyHitSoundThisFrame)
+            if (mEnemies.states[i].mAnimationNo != 36)
             {
-                tryPlayMugenSoundAdvanced(&mSounds, 1, 0, sfxVol);
-                hasPlayedEnemyHitSoundThisFrame = true;
+                playSound(1, 3, sfxVol);
+                auto enemyPos = mEnemies.states[i].mPosition.xy();
+                auto scale = mEnemies.states[i].mScale;
+                auto loveGain = wave->mLoveGain;
+                gGameScreenData.mPlayerLoveCount = addGameValue(gGameScreenData.mPlayerLoveCount, loveGain);
+                addLovePopup(loveGain, enemyPos - Vector2D(0, 30 * scale), scale);
+                // The death animation of the last enemy covers the winning art's load
+                if (isLastEnemyKilled()) getWinningSprites();
             }
-            auto enemyPos = getBlitzEntityPosition(e.entityId).xy();
-            if (gGameScreenData.mStrengthLevel > gGameScreenData.mLevel)
+            changeEnemyAnimationIfDifferent(i, 36);
+
+            if (mEnemies.states[i].mAnimationStep == 5)
             {
-                addBloodSplatter(enemyPos + Vector2D(0, 10), enemyPos.y + 0.001, (*getBlitzMugenAnimationBaseScaleReference(e.entityId)), !getBlitzMugenAnimationIsFacingRight(e.entityId));
+                mEnemies.isToBeDeleted[i] = true;
             }
-            e.life = max(0, e.life - playerStrength);
         }
     }
-    void updateSingleEnemyDying(Enemy& e) {
-        if (!e.life)
+
+    // Collision stats
+    // Prism's collision handler tests every registered pair itself, these only count the hits the game acted on
+    struct CollisionListStats {
+        int hits = 0;
+    };
+    CollisionListStats playerAttackStats;
+    CollisionListStats enemyAttackStats;
+    void reportCollisionStats() {
+        setProfilerCounter("enemies hit by player", playerAttackStats.hits);
+        setProfilerCounter("player hit by enemies", enemyAttackStats.hits);
+        playerAttackStats = CollisionListStats();
+        enemyAttackStats = CollisionListStats();
+    }
+
+    // Blood
+    static constexpr int BLOOD_SPLATTER_AMOUNT = 24;
+    struct BloodSplatter
+    {
+        int entityId;
+        bool isActive;
+    };
+    BloodSplatter bloodSplatters[BLOOD_SPLATTER_AMOUNT];
+    int bloodCounter = 0;
+    void loadBlood() {
+        for (auto& splatter : bloodSplatters)
         {
-            if (getBlitzMugenAnimationAnimationNumber(e.entityId) != 36)
+            splatter.entityId = addBlitzEntity(Vector3D(0, 0, 0));
+            addBlitzMugenAnimationComponent(splatter.entityId, mSprites, mAnimations, -1);
+            splatter.isActive = false;
+        }
+    }
+    void updateBlood() {
+        for (auto& splatter : bloodSplatters)
+        {
+            if (!splatter.isActive) continue;
+            if (!getBlitzMugenAnimationRemainingAnimationTime(splatter.entityId))
             {
-                tryPlayMugenSoundAdvanced(&mSounds, 1, 3, sfxVol);
-                auto enemyPos = getBlitzEntityPosition(e.entityId).xy();
-                int loveGain = loveGains[min(gGameScreenData.mLevel, 2)];
-                gGameScreenData.mPlayerLoveCount += loveGain;
-                addPrismNumberPopup(loveGain, enemyPos.xyz(30) - Vector2D(0, 30 * (*getBlitzMugenAnimationBaseScaleReference(e.entityId))), 1, Vector3D(0, -1.f * (*getBlitzMugenAnimationBaseScaleReference(e.entityId)), 0), *getBlitzMugenAnimationBaseScaleReference(e.entityId), 0, 20);
+                changeBlitzMugenAnimation(splatter.entityId, -1);
+                splatter.isActive = false;
             }
-            changeBlitzMugenAnimationIfDifferent(e.entityId, 36);
+        }
+    }
+    void addBloodSplatter(const Vector2D& pos, double y, double scale, bool isFacingRight)
+    {
+        // All splatters run for the same time, so the next slot in the ring is always the oldest one
+        auto& splatter = bloodSplatters[bloodCounter % BLOOD_SPLATTER_AMOUNT];
+        *getBlitzEntityPositionReference(splatter.entityId) = pos.xyz(yToZ(y) + DEPTH_FRONT_OFFSET);
+        changeBlitzMugenAnimation(splatter.entityId, (bloodCounter % 2) ? 70 : 80);
+        setBlitzMugenAnimationBaseDrawScale(splatter.entityId, scale);
+        setBlitzMugenAnimationFaceDirection(splatter.entityId, isFacingRight);
+        setBlitzMugenAnimationNoLoop(splatter.entityId);
+        splatter.isActive = true;
+        bloodCounter++;
+    }
 
-            if (getBlitzMugenAnimationAnimationStep(e.entityId) == 5)
+    // Love popups
+    // Deaths close to each other in space and time share one summed popup, so a wave dying at once only spawns a few texts
+    static constexpr int LOVE_POPUP_AMOUNT = 8;
+    static constexpr int LOVE_POPUP_MERGE_FRAMES = 6;
+    static constexpr double LOVE_POPUP_MERGE_DISTANCE = 24.0;
+    struct LovePopup {
+        GameValue value;
+        Vector2D pos;
+        double scale;
+        int age;
+        bool isActive = false;
+    };
+    LovePopup lovePopups[LOVE_POPUP_AMOUNT];
+
+    void updateLovePopups() {
+        for (auto& popup : lovePopups)
+        {
+            if (!popup.isActive) continue;
+            if (++popup.age >= LOVE_POPUP_MERGE_FRAMES) emitLovePopup(popup);
+        }
+    }
+    void emitLovePopup(LovePopup& popup) {
+        // Prism popups hold an int, anything beyond that is shown clamped
+        addPrismNumberPopup(int(min(popup.value, GameValue(INT_MAX))), popup.pos.xyz(30), 1, Vector3D(0, -1.f * popup.scale, 0), popup.scale, 0, 20);
+        popup.isActive = false;
+    }
+    void addLovePopup(GameValue value, const Vector2D& pos, double scale) {
+        LovePopup* freeSlot = nullptr;
+        LovePopup* oldest = nullptr;
+        for (auto& popup : lovePopups)
+        {
+            if (!popup.isActive)
+            {
+                if (!freeSlot) freeSlot = &popup;
+                continue;
+            }
+            if (vecLength(popup.pos - pos) < LOVE_POPUP_MERGE_DISTANCE)
             {
-                e.isToBeDeleted = true;
+                popup.value = addGameValue(popup.value, value);
+                return;
             }
+            if (!oldest || popup.age > oldest->age) oldest = &popup;
+        }
+        if (!freeSlot)
+        {
+            emitLovePopup(*oldest);
+            freeSlot = oldest;
         }
+        *freeSlot = { value, pos, scale, 0, true };
     }
 
     // UI
+    struct HudValue
+    {
+        GameValue lastValue = INT64_MIN;
+        bool hasChanged(GameValue value) {
+            if (value == lastValue) return false;
+            lastValue = value;
+            return true;
+        }
+    };
+    void changeHudNumberText(int textId, GameValue value) {
+        char text[NUMBER_FORMAT_BUFFER_SIZE];
+        formatIntegerToBuffer(text, value);
+        changeMugenText(textId, text);
+    }
+
     MugenAnimationHandlerElement* lifebarBG;
     MugenAnimationHandlerElement* lifebarFG;
     int loveCounterTextId;
     int loveCounterBackgroundTextId;
     MugenAnimationHandlerElement* loveCounter;
     void loadUI() {
-        lifebarBG = addMugenAnimation(getMugenAnimation(&mAnimations, 50), &mSprites, Vector3D(70, 230, 30));
-        lifebarFG = addMugenAnimation(getMugenAnimation(&mAnimations, 51), &mSprites, Vector3D(70, 230, 30));
+        lifebarBG = addMugenAnimation(getMugenAnimation(mAnimations, 50), mSprites, Vector3D(70, 230, 30));
+        lifebarFG = addMugenAnimation(getMugenAnimation(mAnimations, 51), mSprites, Vector3D(70, 230, 30));
         loveCounterTextId = addMugenTextMugenStyle("0", Vector3D(90, 218, 31), Vector3DI(1, 0, 1));
         setMugenTextColorRGB(loveCounterTextId, 232 / 256.0, 106 / 256.0, 115 / 256.0);
         setMugenTextScale(loveCounterTextId, 2.0);
         loveCounterBackgroundTextId = addMugenTextMugenStyle("0", Vector3D(91, 219, 30), Vector3DI(1, 0, 1));
         setMugenTextColorRGB(loveCounterBackgroundTextId, 32 / 256.0, 214 / 256.0, 199 / 256.0);
         setMugenTextScale(loveCounterBackgroundTextId, 2.0);
-        loveCounter = addMugenAnimation(getMugenAnimation(&mAnimations, 60), &mSprites, Vector3D(23, 210, 30));
+        loveCounter = addMugenAnimation(getMugenAnimation(mAnimations, 60), mSprites, Vector3D(23, 210, 30));
         setMugenAnimationVisibility(lifebarBG, 0);
         setMugenAnimationVisibility(lifebarFG, 0);
         setMugenAnimationVisibility(loveCounter, 0);
@@ -536,24 +1040,24 @@ public:
         updateLifebar();
         updateLoveCounter();
     }
+    HudValue lifebarWidth;
     void updateLifebar() {
         double t = playerLife / double(maxPlayerLife);
-        setMugenAnimationRectangleWidth(lifebarFG, int(216 * t));
+        int width = int(216 * t);
+        if (!lifebarWidth.hasChanged(width)) return;
+        setMugenAnimationRectangleWidth(lifebarFG, width);
     }
+    HudValue loveCounterValue;
     void updateLoveCounter() {
-        string t = std::to_string(gGameScreenData.mPlayerLoveCount);
-        changeMugenText(loveCounterTextId, t.c_str());
-        changeMugenText(loveCounterBackgroundTextId, t.c_str());
+        if (!loveCounterValue.hasChanged(gGameScreenData.mPlayerLoveCount)) return;
+        changeHudNumberText(loveCounterTextId, gGameScreenData.mPlayerLoveCount);
+        changeHudNumberText(loveCounterBackgroundTextId, gGameScreenData.mPlayerLoveCount);
     }
 
     // Winning
-    MugenAnimationHandlerElement* winningAnimation;
+    MugenAnimationHandlerElement* winningAnimation = nullptr;
     bool isWinning = false;
     int winningTicks = 0;
-    void loadWinning() {
-        winningAnimation = addMugenAnimation(getMugenAnimation(&mAnimations, 100), &mSprites, Vector3D(0, 0, 40));
-        setMugenAnimationVisibility(winningAnimation, false);
-    }
     void updateWinning() {
         if (isUpgradeScreenActive) return;
         updateWinningStart();
@@ -561,10 +1065,9 @@ public:
     }
     void updateWinningStart() {
         if (isWinning) return;
-
-        if (mEnemies.empty())
+        if (isWaveCleared())
         {
-            setMugenAnimationVisibility(winningAnimation, true);
+            winningAnimation = addMugenAnimation(getMugenAnimation(mAnimations, 100), getWinningSprites(), Vector3D(0, 0, 40));
             isWinning = true;
             pauseBlitzMugenAnimation(playerEntity);
             setMugenAnimationVisibility(lifebarBG, 0);
@@ -572,19 +1075,24 @@ public:
             setMugenAnimationVisibility(loveCounter, 0);
             setMugenTextVisibility(loveCounterTextId, 0);
             setMugenTextVisibility(loveCounterBackgroundTextId, 0);
-            stopStreamingMusicFile();
-            tryPlayMugenSoundAdvanced(&mSounds, 100, 0, 1.0);
+            pauseMusicStream();
+            playSound(100, 0, 1.0);
         }
     }
     void updateWinningActive() {
         if (!isWinning) return;
 
         winningTicks++;
-        if (hasPressedStartFlank() || winningTicks > 600)
+        if (hasInput(GAME_INPUT_START_FLANK) || winningTicks > 600)
         {
             gGameScreenData.mLevel++;
-            if (gGameScreenData.mLevel == 3)
+            if (isHeadless())
+            {
+                finishHeadlessWave();
+            }
+            else if (gGameScreenData.mLevel == getWaveAmount())
             {
+                finishReplay();
                 setBookName("outro");
                 setNewScreen(getBookScreen());
             }
@@ -596,22 +1104,18 @@ public:
     }
 
     // Upgrade screen
-    MugenAnimationHandlerElement* upgradeBG;
-    MugenAnimationHandlerElement* upgradeBG2;
-    MugenAnimationHandlerElement* upgradeBuyPointer;
+    MugenAnimationHandlerElement* upgradeBG = nullptr;
+    MugenAnimationHandlerElement* upgradeBG2 = nullptr;
+    MugenAnimationHandlerElement* upgradeBuyPointer = nullptr;
 
-    std::vector<int> levelCosts = { 0, 50, 5000, 500000, 10 * 10 * 10 * 10 * 10 * 10 };
+    std::vector<GameValue> levelCosts = { 0, 50, 5000, 500000, 1000000 };
 
     int loveCostStrengthTextId;
     int loveCostSpeedTextId;
+    HudValue loveCostStrengthValue;
+    HudValue loveCostSpeedValue;
     int selectedUpgradeIndex = 0;
     void loadUpgradeScreen() {
-        upgradeBG = addMugenAnimation(getMugenAnimation(&mAnimations, 120), &mSprites, Vector3D(0, 0, 40));
-        setMugenAnimationVisibility(upgradeBG, false);
-        upgradeBG2 = addMugenAnimation(getMugenAnimation(&mAnimations, 130), &mSprites, Vector3D(0, 0, 41));
-        setMugenAnimationVisibility(upgradeBG2, false);
-        upgradeBuyPointer = addMugenAnimation(getMugenAnimation(&mAnimations, 140), &mSprites, Vector3D(40, 100, 42));
-        setMugenAnimationVisibility(upgradeBuyPointer, false);
         loveCostStrengthTextId = addMugenTextMugenStyle("0", Vector3D(170, 118, 42), Vector3DI(2, 0, 1));
         setMugenTextColorRGB(loveCostStrengthTextId, 232 / 256.0, 106 / 256.0, 115 / 256.0);
         setMugenTextVisibility(loveCostStrengthTextId, false);
@@ -634,22 +1138,28 @@ public:
         if (!playerLife && getBlitzMugenAnimationAnimationNumber(playerEntity) == 16 && getBlitzMugenAnimationAnimationStep(playerEntity) == 5)
         {
             
-            stopStreamingMusicFile();
-            setMugenAnimationVisibility(upgradeBG, true);
-            setMugenAnimationVisibility(upgradeBG2, true);
-            if (levelCosts[gGameScreenData.mStrengthLevel] > gGameScreenData.mPlayerLoveCount && levelCosts[gGameScreenData.mSpeedLevel] > gGameScreenData.mPlayerLoveCount)
+            pauseMusicStream();
+            upgradeBG = addMugenAnimation(getMugenAnimation(mAnimations, 120), getUpgradeSprites(), Vector3D(0, 0, 40));
+            upgradeBG2 = addMugenAnimation(getMugenAnimation(mAnimations, 130), getUpgradeSprites(), Vector3D(0, 0, 41));
+            if (!canAffordUpgrade(0) && !canAffordUpgrade(1))
             {
-                changeMugenAnimation(upgradeBG2, getMugenAnimation(&mAnimations, 110));
+                changeMugenAnimation(upgradeBG2, getMugenAnimation(mAnimations, 110));
                 isUpgradeScreenGameOver = true;
-                tryPlayMugenSoundAdvanced(&mSounds, 100, 1, 1.0);
+                playSound(100, 1, 1.0);
             }
             else
             {
-                setMugenAnimationVisibility(upgradeBuyPointer, true);
+                upgradeBuyPointer = addMugenAnimation(getMugenAnimation(mAnimations, 140), getUpgradeSprites(), Vector3D(40, 100, 42));
                 setMugenTextVisibility(loveCostStrengthTextId, true);
                 setMugenTextVisibility(loveCostSpeedTextId, true);
-                changeMugenText(loveCostStrengthTextId, std::to_string(levelCosts[gGameScreenData.mStrengthLevel]).c_str());
-                changeMugenText(loveCostSpeedTextId, std::to_string(levelCosts[gGameScreenData.mSpeedLevel]).c_str());
+                if (loveCostStrengthValue.hasChanged(levelCosts[gGameScreenData.mStrengthLevel]))
+                {
+                    changeHudNumberText(loveCostStrengthTextId, levelCosts[gGameScreenData.mStrengthLevel]);
+                }
+                if (loveCostSpeedValue.hasChanged(levelCosts[gGameScreenData.mSpeedLevel]))
+                {
+                    changeHudNumberText(loveCostSpeedTextId, levelCosts[gGameScreenData.mSpeedLevel]);
+                }
 
                 double xOffset = 20;
                 double yOffset = -30;
@@ -686,34 +1196,47 @@ public:
         }
     }
     void updateUpgradeScreenGameOver() {
-        if (hasPressedStartFlank())
+        if (hasInput(GAME_INPUT_START_FLANK))
         {
             resetGame();
+            if (isHeadless())
+            {
+                finishHeadlessWave();
+                return;
+            }
+            finishReplay();
             setBookName("intro");
             setNewScreen(getBookScreen());
         }
     }
 
     void updateUpgradeScreenMoveSelection() {
-        if (hasPressedUpFlank() || hasPressedDownFlank())
+        if (hasInput(GAME_INPUT_UP_FLANK) || hasInput(GAME_INPUT_DOWN_FLANK))
         {
-            tryPlayMugenSoundAdvanced(&mSounds, 2, 0, sfxVol);
+            playSound(2, 0, sfxVol);
             selectedUpgradeIndex = (selectedUpgradeIndex + 1) % 2;
         }
     }
+    // Maxed upgrades cost more than the saturated love counter can ever hold
+    GameValue getUpgradeCost(int upgradeIndex) {
+        int currentLevel = upgradeIndex ? gGameScreenData.mSpeedLevel : gGameScreenData.mStrengthLevel;
+        return currentLevel >= 3 ? GAME_VALUE_MAX : levelCosts[currentLevel];
+    }
+    bool canAffordUpgrade(int upgradeIndex) {
+        auto cost = getUpgradeCost(upgradeIndex);
+        return cost != GAME_VALUE_MAX && cost <= gGameScreenData.mPlayerLoveCount;
+    }
     void updateUpgradeScreenConfirmSelection() {
-        if (hasPressedAFlank())
+        if (hasInput(GAME_INPUT_A_FLANK))
         {
-            int currentLevel = selectedUpgradeIndex ? gGameScreenData.mSpeedLevel : gGameScreenData.mStrengthLevel;
-            int necessaryLove = currentLevel >= 3 ? 1000000000 : levelCosts[currentLevel];
-            if (necessaryLove > gGameScreenData.mPlayerLoveCount)
+            if (!canAffordUpgrade(selectedUpgradeIndex))
             {
-                tryPlayMugenSoundAdvanced(&mSounds, 2, 2, sfxVol);
+                playSound(2, 2, sfxVol);
             }
             else
             {
-                tryPlayMugenSoundAdvanced(&mSounds, 2, 1, sfxVol);
-                gGameScreenData.mPlayerLoveCount -= necessaryLove;
+                playSound(2, 1, sfxVol);
+                gGameScreenData.mPlayerLoveCount = subtractGameValue(gGameScreenData.mPlayerLoveCount, getUpgradeCost(selectedUpgradeIndex));
                 if (selectedUpgradeIndex)
                 {
                     gGameScreenData.mSpeedLevel++;
@@ -722,6 +1245,11 @@ public:
                 {
                     gGameScreenData.mStrengthLevel++;
                 }
+                if (isHeadless())
+                {
+                    finishHeadlessWave();
+                    return;
+                }
                 setNewScreen(getGameScreen());
             }
         }
@@ -731,6 +1259,99 @@ public:
         auto pointerPos = getMugenAnimationPositionReference(upgradeBuyPointer);
         pointerPos->y = 100 + 37 * selectedUpgradeIndex;
     }
+
+    // Replay
+    template<typename T>
+    uint32_t hashStateValue(uint32_t hash, const T& value) {
+        return hashReplayBytes(hash, &value, sizeof(T));
+    }
+    uint32_t computeStateHash() {
+        uint32_t hash = REPLAY_HASH_BASIS;
+        hash = hashStateValue(hash, gGameScreenData.mLevel);
+        hash = hashStateValue(hash, gGameScreenData.mPlayerLoveCount);
+        hash = hashStateValue(hash, gGameScreenData.mStrengthLevel);
+        hash = hashStateValue(hash, gGameScreenData.mSpeedLevel);
+        hash = hashStateValue(hash, gGameScreenData.mGameTicks);
+        hash = hashStateValue(hash, gGameScreenData.mRandomState);
+        hash = hashStateValue(hash, playerLife);
+        hash = hashStateValue(hash, pendingSpawnAmount);
+        auto playerPos = getBlitzEntityPosition(playerEntity).xy();
+        hash = hashStateValue(hash, playerPos.x);
+        hash = hashStateValue(hash, playerPos.y);
+        for (size_t i = 0; i < mEnemies.size(); i++)
+        {
+            hash = hashStateValue(hash, mEnemies.states[i].mPosition.x);
+            hash = hashStateValue(hash, mEnemies.states[i].mPosition.y);
+            hash = hashStateValue(hash, mEnemies.lifes[i]);
+            hash = hashStateValue(hash, mEnemies.states[i].mAnimationNo);
+        }
+        return hash;
+    }
+    void updateReplayHash() {
+        if (!isReplayHashTick()) return;
+        submitReplayStateHash(computeStateHash());
+    }
+
+    // Headless
+    void updateHeadless() {
+        if (!isHeadless()) return;
+        int activeBloodSplatterAmount = 0;
+        for (auto& splatter : bloodSplatters)
+        {
+            activeBloodSplatterAmount += splatter.isActive;
+        }
+        reportHeadlessTick(int(mEnemies.size()), activeBloodSplatterAmount);
+    }
+    void finishHeadlessWave() {
+        reportHeadlessWaveFinished();
+        if (isHeadlessSimulationOver()) return;
+        if (gGameScreenData.mLevel == getWaveAmount())
+        {
+            resetGame();
+        }
+        setNewScreen(getGameScreen());
+    }
+
+    GameInput getHeadlessBotInput() {
+        if (isWaveStartActive || isWinning) return GAME_INPUT_START_FLANK;
+        if (isUpgradeScreenActive) return getHeadlessBotUpgradeInput();
+        return getHeadlessBotCombatInput();
+    }
+    GameInput getHeadlessBotUpgradeInput() {
+        if (isUpgradeScreenGameOver) return GAME_INPUT_START_FLANK;
+        if (canAffordUpgrade(selectedUpgradeIndex)) return GAME_INPUT_A_FLANK;
+        if (canAffordUpgrade((selectedUpgradeIndex + 1) % 2)) return GAME_INPUT_DOWN_FLANK;
+        return 0;
+    }
+    GameInput getHeadlessBotCombatInput() {
+        if (mEnemies.empty()) return 0;
+        auto playerPos = getBlitzEntityPosition(playerEntity).xy();
+        int enemyIndex = mEnemyGrid.findNearest(playerPos);
+        if (enemyIndex == -1) return 0;
+        auto enemyPos = mEnemies.states[enemyIndex].mPosition.xy();
+
+        GameInput botInput = 0;
+        bool isRightOfEnemy = playerPos.x > enemyPos.x;
+        auto target = Vector2D(enemyPos.x + (isRightOfEnemy ? 15 : -15), enemyPos.y);
+        if (target.x < playerPos.x - 2) botInput |= GAME_INPUT_LEFT;
+        else if (target.x > playerPos.x + 2) botInput |= GAME_INPUT_RIGHT;
+        if (target.y < playerPos.y - 2) botInput |= GAME_INPUT_UP;
+        else if (target.y > playerPos.y + 2) botInput |= GAME_INPUT_DOWN;
+
+        bool isFacingEnemy = bool(getBlitzMugenAnimationIsFacingRight(playerEntity)) != isRightOfEnemy;
+        if (!botInput && !isFacingEnemy)
+        {
+            botInput |= isRightOfEnemy ? GAME_INPUT_LEFT : GAME_INPUT_RIGHT;
+        }
+
+        auto animationNo = getBlitzMugenAnimationAnimationNumber(playerEntity);
+        bool isReady = (animationNo == 10) || (animationNo == 11);
+        if (isReady && isFacingEnemy && abs(playerPos.x - enemyPos.x) < 25 && abs(playerPos.y - enemyPos.y) < 4)
+        {
+            botInput |= GAME_INPUT_A_FLANK;
+        }
+        return botInput;
+    }
 };
 
 EXPORT_SCREEN_CLASS(GameScreen);
@@ -742,6 +1363,7 @@ void resetGame()
     gGameScreenData.mStrengthLevel = 0;
     gGameScreenData.mSpeedLevel = 0;
     gGameScreenData.mGameTicks = 0;
+    gGameScreenData.mRandomState = max(1u, startReplayRun());
 }
 
 std::string getSpeedRunString() {
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+// Love, life and strength values. They span many orders of magnitude between levels, so they are kept in 64 bit and clamp instead of wrapping.
+typedef int64_t GameValue;
+
+#define GAME_VALUE_MAX INT64_MAX
+
+static inline GameValue addGameValue(GameValue a, GameValue b)
+{
+    return a > GAME_VALUE_MAX - b ? GAME_VALUE_MAX : a + b;
+}
+
+// Game values never go below zero, so running out of life or love stops at 0
+static inline GameValue subtractGameValue(GameValue a, GameValue b)
+{
+    return a < b ? 0 : a - b;
+}
@@ -0,0 +1,75 @@
+#include "headless.h"
+
+#include <chrono>
+#include <prism/blitz.h>
+
+#include "replay.h"
+
+static struct
+{
+    bool mIsActive = false;
+    int mWaveAmount = 1000;
+    int mWavesFinished;
+    uint64_t mTicks;
+    int mPeakEnemyCount;
+    int mPeakEffectCount;
+    std::chrono::steady_clock::time_point mStartTime;
+} gHeadlessData;
+
+bool parseHeadlessArguments(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless")) continue;
+
+        gHeadlessData.mIsActive = true;
+        if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            gHeadlessData.mWaveAmount = atoi(argv[i + 1]);
+        }
+    }
+    return gHeadlessData.mIsActive;
+}
+
+bool isHeadless()
+{
+    return gHeadlessData.mIsActive;
+}
+
+void startHeadlessSimulation()
+{
+    gHeadlessData.mWavesFinished = 0;
+    gHeadlessData.mTicks = 0;
+    gHeadlessData.mPeakEnemyCount = 0;
+    gHeadlessData.mPeakEffectCount = 0;
+    gHeadlessData.mStartTime = std::chrono::steady_clock::now();
+}
+
+void reportHeadlessTick(int enemyCount, int effectCount)
+{
+    gHeadlessData.mTicks++;
+    gHeadlessData.mPeakEnemyCount = max(gHeadlessData.mPeakEnemyCount, enemyCount);
+    gHeadlessData.mPeakEffectCount = max(gHeadlessData.mPeakEffectCount, effectCount);
+}
+
+void reportHeadlessWaveFinished()
+{
+    gHeadlessData.mWavesFinished++;
+    if (isHeadlessSimulationOver())
+    {
+        abortScreenHandling();
+    }
+}
+
+bool isHeadlessSimulationOver()
+{
+    return gHeadlessData.mWavesFinished >= gHeadlessData.mWaveAmount;
+}
+
+void printHeadlessReport()
+{
+    auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - gHeadlessData.mStartTime).count();
+    double ticksPerSecond = duration > 0 ? gHeadlessData.mTicks / duration : 0;
+    printf("Headless run: seed %u, %d waves, %llu ticks in %.2fs (%.0f ticks/s)\n", getReplaySeed(), gHeadlessData.mWavesFinished, (unsigned long long)gHeadlessData.mTicks, duration, ticksPerSecond);
+    printf("Peak entities: %d enemies, %d effects\n", gHeadlessData.mPeakEnemyCount, gHeadlessData.mPeakEffectCount);
+}
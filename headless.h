@@ -0,0 +1,10 @@
+#pragma once
+
+bool parseHeadlessArguments(int argc, char** argv);
+bool isHeadless();
+
+void startHeadlessSimulation();
+void reportHeadlessTick(int enemyCount, int effectCount);
+void reportHeadlessWaveFinished();
+bool isHeadlessSimulationOver();
+void printHeadlessReport();
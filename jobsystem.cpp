@@ -0,0 +1,170 @@
+#include "jobsystem.h"
+
+#include <algorithm>
+
+#if defined(DREAMCAST) || defined(__EMSCRIPTEN__)
+#define JOB_SYSTEM_SERIAL
+#endif
+
+#ifndef JOB_SYSTEM_SERIAL
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#define JOB_SYSTEM_MAX_THREADS 8
+
+// Every thread owns a contiguous run of chunks and claims them front to back.
+// Once its own run is empty it claims chunks from the other threads' runs, so one slow chunk does not stall the rest.
+struct JobQueue
+{
+    std::atomic<size_t> mNext;
+    size_t mEnd;
+};
+
+static struct
+{
+    std::vector<std::thread> mWorkers;
+    std::unique_ptr<JobQueue[]> mQueues;
+    int mThreadAmount = 1;
+    bool mHasStarted = false;
+
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::condition_variable mFinished;
+    uint64_t mGeneration = 0;
+    int mBusyWorkers = 0;
+    bool mIsShuttingDown = false;
+
+    size_t mAmount;
+    size_t mGrainSize;
+    JobRangeFunction mFunc;
+    void* mCaller;
+} gJobSystemData;
+
+static void runJobChunks(int thread)
+{
+    for (int i = 0; i < gJobSystemData.mThreadAmount; i++)
+    {
+        auto& queue = gJobSystemData.mQueues[(thread + i) % gJobSystemData.mThreadAmount];
+        for (;;)
+        {
+            auto chunk = queue.mNext.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= queue.mEnd) break;
+            auto begin = chunk * gJobSystemData.mGrainSize;
+            auto end = std::min(begin + gJobSystemData.mGrainSize, gJobSystemData.mAmount);
+            gJobSystemData.mFunc(gJobSystemData.mCaller, begin, end);
+        }
+    }
+}
+
+static void jobWorkerLoop(int thread)
+{
+    uint64_t seenGeneration = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(gJobSystemData.mMutex);
+            gJobSystemData.mWakeUp.wait(lock, [&]() { return gJobSystemData.mIsShuttingDown || gJobSystemData.mGeneration != seenGeneration; });
+            if (gJobSystemData.mIsShuttingDown) return;
+            seenGeneration = gJobSystemData.mGeneration;
+        }
+
+        runJobChunks(thread);
+
+        std::lock_guard<std::mutex> lock(gJobSystemData.mMutex);
+        if (!--gJobSystemData.mBusyWorkers)
+        {
+            gJobSystemData.mFinished.notify_one();
+        }
+    }
+}
+
+// Workers are only spawned once a range needs more than one chunk, so startup and runs that never get there stay single threaded
+static void startJobWorkers()
+{
+    gJobSystemData.mHasStarted = true;
+    int threadAmount = std::min(int(std::thread::hardware_concurrency()), JOB_SYSTEM_MAX_THREADS);
+    gJobSystemData.mThreadAmount = std::max(threadAmount, 1);
+    gJobSystemData.mQueues.reset(new JobQueue[gJobSystemData.mThreadAmount]);
+    gJobSystemData.mIsShuttingDown = false;
+    // The calling thread is thread 0 and works through its own chunks while it waits
+    for (int i = 1; i < gJobSystemData.mThreadAmount; i++)
+    {
+        gJobSystemData.mWorkers.emplace_back(jobWorkerLoop, i);
+    }
+}
+
+void shutdownJobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(gJobSystemData.mMutex);
+        gJobSystemData.mIsShuttingDown = true;
+    }
+    gJobSystemData.mWakeUp.notify_all();
+    for (auto& worker : gJobSystemData.mWorkers)
+    {
+        worker.join();
+    }
+    gJobSystemData.mWorkers.clear();
+    gJobSystemData.mThreadAmount = 1;
+    gJobSystemData.mHasStarted = false;
+}
+
+void runParallelFor(size_t amount, size_t grainSize, JobRangeFunction func, void* caller)
+{
+    grainSize = std::max(grainSize, size_t(1));
+    // Waking the workers costs more than a single chunk of work
+    if (amount <= grainSize)
+    {
+        if (amount) func(caller, 0, amount);
+        return;
+    }
+    if (!gJobSystemData.mHasStarted) startJobWorkers();
+    if (gJobSystemData.mWorkers.empty())
+    {
+        func(caller, 0, amount);
+        return;
+    }
+
+    gJobSystemData.mAmount = amount;
+    gJobSystemData.mGrainSize = grainSize;
+    gJobSystemData.mFunc = func;
+    gJobSystemData.mCaller = caller;
+
+    size_t chunkAmount = (amount + grainSize - 1) / grainSize;
+    size_t threadAmount = size_t(gJobSystemData.mThreadAmount);
+    for (size_t i = 0; i < threadAmount; i++)
+    {
+        gJobSystemData.mQueues[i].mNext.store(chunkAmount * i / threadAmount, std::memory_order_relaxed);
+        gJobSystemData.mQueues[i].mEnd = chunkAmount * (i + 1) / threadAmount;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(gJobSystemData.mMutex);
+        gJobSystemData.mBusyWorkers = int(gJobSystemData.mWorkers.size());
+        gJobSystemData.mGeneration++;
+    }
+    gJobSystemData.mWakeUp.notify_all();
+
+    runJobChunks(0);
+
+    std::unique_lock<std::mutex> lock(gJobSystemData.mMutex);
+    gJobSystemData.mFinished.wait(lock, []() { return !gJobSystemData.mBusyWorkers; });
+}
+
+#else
+
+void shutdownJobSystem() {}
+
+void runParallelFor(size_t amount, size_t grainSize, JobRangeFunction func, void* caller)
+{
+    (void)grainSize;
+    if (amount) func(caller, 0, amount);
+}
+
+#endif
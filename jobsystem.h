@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stddef.h>
+
+typedef void(*JobRangeFunction)(void* caller, size_t begin, size_t end);
+
+// Workers start on the first runParallelFor with more than one chunk, shutdown joins them
+void shutdownJobSystem();
+
+// Splits [0, amount) into chunks of grainSize and returns once every chunk has run.
+// Chunks run on any thread in any order, so func may only write to the elements of its own range.
+void runParallelFor(size_t amount, size_t grainSize, JobRangeFunction func, void* caller);
@@ -11,6 +11,11 @@
 
 #include "gamescreen.h"
 #include "bookscreen.h"
+#include "assetcache.h"
+#include "headless.h"
+#include "replay.h"
+#include "jobsystem.h"
+#include "musicstream.h"
 
 #ifdef DREAMCAST
 KOS_INIT_FLAGS(INIT_DEFAULT);
@@ -20,6 +25,9 @@ KOS_INIT_FLAGS(INIT_DEFAULT);
 // #define DEVELOP
 
 void exitGame() {
+	finishReplay();
+	stopMusicStream();
+	shutdownJobSystem();
 	shutdownPrismWrapper();
 
 #ifdef DEVELOP
@@ -34,10 +42,29 @@ void exitGame() {
 #endif
 }
 
-int main(int argc, char** argv) {
-	(void)argc;
-	(void)argv;
+void runHeadlessSimulation() {
+	// Logic ticks per presented frame, the wrapper does not wait for vsync between them
+	setWrapperTimeDilatation(64);
+	setMinimumLogType(LOG_TYPE_NONE);
+
+	startHeadlessSimulation();
+	// Seeds the first run like a replay does, so --seed applies and a recorded headless run replays in sync
+	resetGame();
+	startScreenHandling(getGameScreen());
+	printHeadlessReport();
+	finishReplay();
+}
 
+void runReplayVerification() {
+	setWrapperTimeDilatation(64);
+	setMinimumLogType(LOG_TYPE_NONE);
+
+	startReplay();
+	resetGame();
+	startScreenHandling(getGameScreen());
+}
+
+int main(int argc, char** argv) {
 	#ifdef DEVELOP
 	setDevelopMode();
 	#endif
@@ -45,6 +72,8 @@ int main(int argc, char** argv) {
 	setGameName("JustBeYourself");
 	setScreenSize(320, 240);
 	
+	// Prism has no windowless mode, so headless runs still open a window and need a display (Xvfb on CI boxes)
+	bool isHeadlessRun = parseHeadlessArguments(argc, argv);
 	initPrismWrapperWithConfigFile("data/config.cfg");
 	setFont("$/rd/fonts/segoe.hdr", "$/rd/fonts/segoe.pkg");
 
@@ -52,6 +81,39 @@ int main(int argc, char** argv) {
 	addMugenFont(1, "font/f6x9.fnt");
 	addMugenFont(2, "font/jg.fnt");
 
+	if (isOnDreamcast()) {
+		setAssetCacheMemoryBudget(1280 * 1024);
+	}
+	preloadCachedAsset("game/GAME.sff");
+	preloadCachedAsset("game/GAME.air");
+	preloadCachedAsset("game/GAME.snd");
+	if (!isHeadlessRun) {
+		preloadCachedAsset("game/BOOK.snd");
+		preloadCachedAsset("game/STINGERS.snd");
+	}
+	if (!isOnDreamcast() && !isHeadlessRun) {
+		// Full screen art does not fit next to the combat set on Dreamcast, there it is loaded when needed
+		preloadCachedAsset("game/WINNING.sff");
+		preloadCachedAsset("game/UPGRADE.sff");
+	}
+
+	if (parseReplayArguments(argc, argv)) {
+		runReplayVerification();
+		stopMusicStream();
+		shutdownJobSystem();
+		shutdownPrismWrapper();
+		return 0;
+	}
+	startReplay();
+
+	if (isHeadlessRun) {
+		runHeadlessSimulation();
+		stopMusicStream();
+		shutdownJobSystem();
+		shutdownPrismWrapper();
+		return 0;
+	}
+
 	logg("Check framerate");
 	FramerateSelectReturnType framerateReturnType = selectFramerate();
 	if (framerateReturnType == FRAMERATE_SCREEN_RETURN_ABORT) {
@@ -0,0 +1,45 @@
+#include "musicstream.h"
+
+#include <string>
+#include <prism/sound.h>
+
+// Lives outside of the screens, so switching between screens that share a track keeps the open stream instead of reopening it
+static struct
+{
+    std::string mPath;
+    bool mIsPaused = false;
+} gMusicStreamData;
+
+void startMusicStream(const char* path)
+{
+    if (gMusicStreamData.mPath == path)
+    {
+        if (!gMusicStreamData.mIsPaused) return;
+        resumeMusic();
+        gMusicStreamData.mIsPaused = false;
+        return;
+    }
+
+    if (!gMusicStreamData.mPath.empty())
+    {
+        stopStreamingMusicFile();
+    }
+    streamMusicFile(path);
+    gMusicStreamData.mPath = path;
+    gMusicStreamData.mIsPaused = false;
+}
+
+void pauseMusicStream()
+{
+    if (gMusicStreamData.mPath.empty() || gMusicStreamData.mIsPaused) return;
+    pauseMusic();
+    gMusicStreamData.mIsPaused = true;
+}
+
+void stopMusicStream()
+{
+    if (gMusicStreamData.mPath.empty()) return;
+    stopStreamingMusicFile();
+    gMusicStreamData.mPath.clear();
+    gMusicStreamData.mIsPaused = false;
+}
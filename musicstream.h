@@ -0,0 +1,5 @@
+#pragma once
+
+void startMusicStream(const char* path);
+void pauseMusicStream();
+void stopMusicStream();
@@ -0,0 +1,30 @@
+#include "numberformat.h"
+
+int formatIntegerToBuffer(char* buffer, int64_t value)
+{
+    char digits[NUMBER_FORMAT_BUFFER_SIZE];
+    int digitAmount = 0;
+    uint64_t remaining = value < 0 ? 0ull - uint64_t(value) : uint64_t(value);
+    do
+    {
+        // Split in 32 bit chunks where possible, 64 bit division is slow on the SH4
+        if (remaining <= UINT32_MAX)
+        {
+            uint32_t small = uint32_t(remaining);
+            digits[digitAmount++] = char('0' + small % 10);
+            remaining = small / 10;
+            continue;
+        }
+        digits[digitAmount++] = char('0' + remaining % 10);
+        remaining /= 10;
+    } while (remaining);
+
+    int length = 0;
+    if (value < 0) buffer[length++] = '-';
+    while (digitAmount)
+    {
+        buffer[length++] = digits[--digitAmount];
+    }
+    buffer[length] = '\0';
+    return length;
+}
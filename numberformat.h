@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+
+#define NUMBER_FORMAT_BUFFER_SIZE 24
+
+int formatIntegerToBuffer(char* buffer, int64_t value);
@@ -0,0 +1,248 @@
+#include "profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <atomic>
+#include <prism/blitz.h>
+
+#define PROFILER_SECTION_AMOUNT 16
+#define PROFILER_COUNTER_AMOUNT 8
+#define PROFILER_SAMPLE_AMOUNT 256
+#define PROFILER_OVERLAY_REFRESH_TICKS 30
+
+struct ProfilerSection
+{
+    const char* mName;
+    float mSamples[PROFILER_SAMPLE_AMOUNT];
+    std::atomic<uint32_t> mWriteIndex;
+    int mTextId;
+};
+
+struct ProfilerCounter
+{
+    const char* mName;
+    int mValue;
+    int mTextId;
+};
+
+static struct
+{
+    ProfilerSection mSections[PROFILER_SECTION_AMOUNT];
+    int mSectionAmount = 0;
+    ProfilerCounter mCounters[PROFILER_COUNTER_AMOUNT];
+    int mCounterAmount = 0;
+    int mEngineSection = -1;
+    int mPresentSection = -1;
+    std::chrono::steady_clock::time_point mFrameEnd;
+    std::chrono::steady_clock::time_point mDrawEnd;
+    bool mHasFrameEnd = false;
+    bool mHasDrawEnd = false;
+
+    bool mIsOverlayVisible = false;
+    int mOverlayTicks = 0;
+} gProfilerData;
+
+static int getProfilerSection(const char* name)
+{
+    for (int i = 0; i < gProfilerData.mSectionAmount; i++)
+    {
+        if (gProfilerData.mSections[i].mName == name) return i;
+    }
+    if (gProfilerData.mSectionAmount == PROFILER_SECTION_AMOUNT) return PROFILER_SECTION_AMOUNT - 1;
+
+    auto& section = gProfilerData.mSections[gProfilerData.mSectionAmount];
+    section.mName = name;
+    section.mWriteIndex = 0;
+    section.mTextId = -1;
+    return gProfilerData.mSectionAmount++;
+}
+
+static void addProfilerSample(int sectionIndex, std::chrono::steady_clock::duration duration)
+{
+    // Single writer per section, so a relaxed bump of the ring index is all the synchronisation the overlay needs
+    auto& section = gProfilerData.mSections[sectionIndex];
+    auto index = section.mWriteIndex.fetch_add(1, std::memory_order_relaxed);
+    section.mSamples[index % PROFILER_SAMPLE_AMOUNT] = std::chrono::duration<float, std::micro>(duration).count();
+}
+
+// Counters are looked up by name pointer like sections and show their latest value in the overlay
+void setProfilerCounter(const char* name, int value)
+{
+    for (int i = 0; i < gProfilerData.mCounterAmount; i++)
+    {
+        if (gProfilerData.mCounters[i].mName != name) continue;
+        gProfilerData.mCounters[i].mValue = value;
+        return;
+    }
+    if (gProfilerData.mCounterAmount == PROFILER_COUNTER_AMOUNT) return;
+
+    auto& counter = gProfilerData.mCounters[gProfilerData.mCounterAmount++];
+    counter.mName = name;
+    counter.mValue = value;
+}
+
+ProfilerScope::ProfilerScope(const char* name)
+    : mSection(getProfilerSection(name))
+    , mStart(std::chrono::steady_clock::now())
+{
+}
+
+ProfilerScope::~ProfilerScope()
+{
+    addProfilerSample(mSection, std::chrono::steady_clock::now() - mStart);
+}
+
+// The frame between two GameScreen updates is split at the draw of the profiler's own actor.
+// "engine" runs from the end of the update until then and covers the handlers updated after the screen and the actors' drawing.
+// "present" is the rest: buffer swap, vsync wait and handlers updated before the screen, so idle time does not count as engine cost.
+static void drawProfilerFrame(void*)
+{
+    if (!gProfilerData.mHasFrameEnd) return;
+    gProfilerData.mDrawEnd = std::chrono::steady_clock::now();
+    gProfilerData.mHasDrawEnd = true;
+    addProfilerSample(gProfilerData.mEngineSection, gProfilerData.mDrawEnd - gProfilerData.mFrameEnd);
+}
+
+static void loadProfilerFrame(void*)
+{
+}
+
+void startProfilerFrame()
+{
+    if (gProfilerData.mEngineSection == -1)
+    {
+        gProfilerData.mEngineSection = getProfilerSection("engine");
+        gProfilerData.mPresentSection = getProfilerSection("present");
+    }
+    if (gProfilerData.mHasDrawEnd)
+    {
+        addProfilerSample(gProfilerData.mPresentSection, std::chrono::steady_clock::now() - gProfilerData.mDrawEnd);
+        gProfilerData.mHasDrawEnd = false;
+    }
+}
+
+void finishProfilerFrame()
+{
+    gProfilerData.mFrameEnd = std::chrono::steady_clock::now();
+    gProfilerData.mHasFrameEnd = true;
+}
+
+struct ProfilerStats
+{
+    float mMin;
+    float mAverage;
+    float mP99;
+};
+
+static ProfilerStats calculateProfilerStats(const ProfilerSection& section)
+{
+    int sampleAmount = int(min(section.mWriteIndex.load(std::memory_order_relaxed), uint32_t(PROFILER_SAMPLE_AMOUNT)));
+    if (!sampleAmount) return ProfilerStats{ 0, 0, 0 };
+
+    float samples[PROFILER_SAMPLE_AMOUNT];
+    float sum = 0;
+    for (int i = 0; i < sampleAmount; i++)
+    {
+        samples[i] = section.mSamples[i];
+        sum += samples[i];
+    }
+    auto p99 = samples + (sampleAmount * 99) / 100;
+    std::nth_element(samples, p99, samples + sampleAmount);
+    return ProfilerStats{ *std::min_element(samples, samples + sampleAmount), sum / sampleAmount, *p99 };
+}
+
+void loadProfilerOverlay()
+{
+    for (int i = 0; i < PROFILER_SECTION_AMOUNT; i++)
+    {
+        auto& section = gProfilerData.mSections[i];
+        section.mTextId = addMugenTextMugenStyle(" ", Vector3D(2, 8 + 7 * i, 60), Vector3DI(-1, 0, 1));
+        setMugenTextVisibility(section.mTextId, gProfilerData.mIsOverlayVisible);
+    }
+    for (int i = 0; i < PROFILER_COUNTER_AMOUNT; i++)
+    {
+        auto& counter = gProfilerData.mCounters[i];
+        counter.mTextId = addMugenTextMugenStyle(" ", Vector3D(2, 8 + 7 * (PROFILER_SECTION_AMOUNT + i), 60), Vector3DI(-1, 0, 1));
+        setMugenTextVisibility(counter.mTextId, gProfilerData.mIsOverlayVisible);
+    }
+    gProfilerData.mOverlayTicks = 0;
+    gProfilerData.mHasFrameEnd = false;
+    gProfilerData.mHasDrawEnd = false;
+
+    // Loaded after blitz and the screen's other actors, so it is drawn last
+    static ActorBlueprint profilerFrameBlueprint = makeActorBlueprint(loadProfilerFrame, nullptr, nullptr, drawProfilerFrame);
+    instantiateActor(&profilerFrameBlueprint);
+}
+
+static void setProfilerOverlayVisibility(bool isVisible)
+{
+    gProfilerData.mIsOverlayVisible = isVisible;
+    for (int i = 0; i < PROFILER_SECTION_AMOUNT; i++)
+    {
+        setMugenTextVisibility(gProfilerData.mSections[i].mTextId, isVisible && i < gProfilerData.mSectionAmount);
+    }
+    for (int i = 0; i < PROFILER_COUNTER_AMOUNT; i++)
+    {
+        setMugenTextVisibility(gProfilerData.mCounters[i].mTextId, isVisible && i < gProfilerData.mCounterAmount);
+    }
+}
+
+void updateProfilerOverlay()
+{
+    if (hasPressedYFlank())
+    {
+        setProfilerOverlayVisibility(!gProfilerData.mIsOverlayVisible);
+    }
+    if (hasPressedXFlank())
+    {
+        dumpProfilerCSV("profiler.csv");
+    }
+    if (!gProfilerData.mIsOverlayVisible) return;
+    if (gProfilerData.mOverlayTicks++ % PROFILER_OVERLAY_REFRESH_TICKS) return;
+
+    for (int i = 0; i < gProfilerData.mSectionAmount; i++)
+    {
+        auto& section = gProfilerData.mSections[i];
+        auto stats = calculateProfilerStats(section);
+        char text[100];
+        snprintf(text, sizeof(text), "%s min %.0f avg %.0f p99 %.0f us", section.mName, stats.mMin, stats.mAverage, stats.mP99);
+        changeMugenText(section.mTextId, text);
+        setMugenTextVisibility(section.mTextId, true);
+    }
+    for (int i = 0; i < gProfilerData.mCounterAmount; i++)
+    {
+        auto& counter = gProfilerData.mCounters[i];
+        char text[100];
+        snprintf(text, sizeof(text), "%s %d", counter.mName, counter.mValue);
+        changeMugenText(counter.mTextId, text);
+        setMugenTextVisibility(counter.mTextId, true);
+    }
+}
+
+void dumpProfilerCSV(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) return;
+
+    fprintf(file, "sample");
+    for (int i = 0; i < gProfilerData.mSectionAmount; i++)
+    {
+        fprintf(file, ",%s", gProfilerData.mSections[i].mName);
+    }
+    fprintf(file, "\n");
+    for (int sample = 0; sample < PROFILER_SAMPLE_AMOUNT; sample++)
+    {
+        fprintf(file, "%d", sample);
+        for (int i = 0; i < gProfilerData.mSectionAmount; i++)
+        {
+            auto& section = gProfilerData.mSections[i];
+            auto writeIndex = section.mWriteIndex.load(std::memory_order_relaxed);
+            auto oldestIndex = writeIndex >= PROFILER_SAMPLE_AMOUNT ? writeIndex : 0;
+            fprintf(file, ",%.2f", section.mSamples[(oldestIndex + sample) % PROFILER_SAMPLE_AMOUNT]);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+
+// Set JBY_PROFILER=1 for make or -DJBY_PROFILER=ON for CMake, Windows debug builds define it in the project
+#ifdef JBY_PROFILER
+#define PROFILER_ENABLED
+#endif
+
+#ifdef PROFILER_ENABLED
+
+#include <chrono>
+
+class ProfilerScope
+{
+public:
+    ProfilerScope(const char* name);
+    ~ProfilerScope();
+
+private:
+    int mSection;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+#define PROFILE_SCOPE_NAME(line) profilerScope##line
+#define PROFILE_SCOPE_LINE(name, line) ProfilerScope PROFILE_SCOPE_NAME(line)(name)
+#define PROFILE_SCOPE(name) PROFILE_SCOPE_LINE(name, __LINE__)
+
+void startProfilerFrame();
+void finishProfilerFrame();
+void setProfilerCounter(const char* name, int value);
+
+void loadProfilerOverlay();
+void updateProfilerOverlay();
+void dumpProfilerCSV(const char* path);
+
+#else
+
+#define PROFILE_SCOPE(name)
+
+inline void startProfilerFrame() {}
+inline void finishProfilerFrame() {}
+inline void setProfilerCounter(const char*, int) {}
+
+inline void loadProfilerOverlay() {}
+inline void updateProfilerOverlay() {}
+inline void dumpProfilerCSV(const char*) {}
+
+#endif
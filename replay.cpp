@@ -0,0 +1,258 @@
+#include "replay.h"
+
+#include <ctime>
+#include <prism/blitz.h>
+
+#define REPLAY_MAGIC 0x5259424A
+#define REPLAY_VERSION 1
+#define REPLAY_HASH_INTERVAL 60
+#define FNV_PRIME 16777619u
+
+struct InputRun
+{
+    GameInput mInput;
+    uint16_t mLength;
+};
+
+static struct
+{
+    bool mIsRecording = false;
+    bool mIsPlaying = false;
+    bool mIsFinished = false;
+    std::string mPath;
+    uint32_t mBaseSeed = uint32_t(time(nullptr));
+    uint32_t mSeed;
+    uint32_t mRunAmount = 0;
+
+    std::vector<InputRun> mRuns;
+    std::vector<uint32_t> mHashes;
+    uint32_t mTick;
+    size_t mRunIndex;
+    uint16_t mRunPosition;
+    size_t mHashIndex;
+} gReplayData;
+
+bool parseReplayArguments(int argc, char** argv)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (!strcmp(argv[i], "--record"))
+        {
+            gReplayData.mIsRecording = true;
+            gReplayData.mPath = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "--replay"))
+        {
+            gReplayData.mIsPlaying = true;
+            gReplayData.mPath = argv[i + 1];
+        }
+        else if (!strcmp(argv[i], "--seed"))
+        {
+            // Replays bring their own seed, this only fixes the seeds of new runs
+            gReplayData.mBaseSeed = uint32_t(strtoul(argv[i + 1], nullptr, 10));
+        }
+    }
+    return gReplayData.mIsPlaying;
+}
+
+bool isRecordingReplay()
+{
+    return gReplayData.mIsRecording && !gReplayData.mIsFinished;
+}
+
+bool isPlayingReplay()
+{
+    return gReplayData.mIsPlaying;
+}
+
+uint32_t getReplaySeed()
+{
+    return gReplayData.mIsPlaying || gReplayData.mRunAmount ? gReplayData.mSeed : gReplayData.mBaseSeed;
+}
+
+// Finalizer of splitmix32, spreads consecutive run numbers over the whole seed range
+static uint32_t mixSeed(uint32_t seed, uint32_t run)
+{
+    uint32_t x = seed + run * 0x9E3779B9u;
+    x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+    x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+    return x ^ (x >> 16);
+}
+
+uint32_t startReplayRun()
+{
+    if (gReplayData.mIsPlaying) return gReplayData.mSeed;
+
+    // The first run uses the base seed as is, so --seed N reproduces it; later runs of the session get their own
+    uint32_t seed = gReplayData.mRunAmount ? mixSeed(gReplayData.mBaseSeed, gReplayData.mRunAmount) : gReplayData.mBaseSeed;
+    if (!gReplayData.mRunAmount)
+    {
+        // Recordings stop with the first run, so this is the seed they store
+        gReplayData.mSeed = seed;
+    }
+    gReplayData.mRunAmount++;
+    return seed;
+}
+
+template<typename T>
+static bool readValue(FILE* file, T& value)
+{
+    return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+template<typename T>
+static void writeValue(FILE* file, const T& value)
+{
+    fwrite(&value, sizeof(T), 1, file);
+}
+
+static bool loadReplayFile()
+{
+    FILE* file = fopen(gReplayData.mPath.c_str(), "rb");
+    if (!file) return false;
+
+    uint32_t magic, version, hashInterval, runAmount, hashAmount;
+    bool isValid = readValue(file, magic) && magic == REPLAY_MAGIC;
+    isValid = isValid && readValue(file, version) && version == REPLAY_VERSION;
+    isValid = isValid && readValue(file, gReplayData.mSeed);
+    isValid = isValid && readValue(file, hashInterval) && hashInterval == REPLAY_HASH_INTERVAL;
+    isValid = isValid && readValue(file, runAmount);
+    for (uint32_t i = 0; isValid && i < runAmount; i++)
+    {
+        InputRun run;
+        isValid = readValue(file, run.mInput) && readValue(file, run.mLength);
+        gReplayData.mRuns.push_back(run);
+    }
+    isValid = isValid && readValue(file, hashAmount);
+    for (uint32_t i = 0; isValid && i < hashAmount; i++)
+    {
+        uint32_t hash;
+        isValid = readValue(file, hash);
+        gReplayData.mHashes.push_back(hash);
+    }
+    fclose(file);
+    return isValid;
+}
+
+static void saveReplayFile()
+{
+    FILE* file = fopen(gReplayData.mPath.c_str(), "wb");
+    if (!file)
+    {
+        logErrorFormat("Unable to write replay %s", gReplayData.mPath.c_str());
+        return;
+    }
+
+    writeValue(file, uint32_t(REPLAY_MAGIC));
+    writeValue(file, uint32_t(REPLAY_VERSION));
+    writeValue(file, gReplayData.mSeed);
+    writeValue(file, uint32_t(REPLAY_HASH_INTERVAL));
+    writeValue(file, uint32_t(gReplayData.mRuns.size()));
+    for (auto& run : gReplayData.mRuns)
+    {
+        writeValue(file, run.mInput);
+        writeValue(file, run.mLength);
+    }
+    writeValue(file, uint32_t(gReplayData.mHashes.size()));
+    for (auto hash : gReplayData.mHashes)
+    {
+        writeValue(file, hash);
+    }
+    fclose(file);
+}
+
+void startReplay()
+{
+    gReplayData.mTick = 0;
+    gReplayData.mRunIndex = 0;
+    gReplayData.mRunPosition = 0;
+    gReplayData.mHashIndex = 0;
+    if (gReplayData.mIsPlaying && !loadReplayFile())
+    {
+        printf("Unable to read replay %s\n", gReplayData.mPath.c_str());
+        gReplayData.mRuns.clear();
+    }
+}
+
+void finishReplay()
+{
+    if (gReplayData.mIsFinished) return;
+    gReplayData.mIsFinished = true;
+
+    if (gReplayData.mIsRecording)
+    {
+        saveReplayFile();
+    }
+    else if (gReplayData.mIsPlaying)
+    {
+        printf("Replay finished after %u ticks, %zu/%zu state hashes matched\n", gReplayData.mTick, gReplayData.mHashIndex, gReplayData.mHashes.size());
+        abortScreenHandling();
+    }
+}
+
+void recordReplayInput(GameInput input)
+{
+    if (!isRecordingReplay()) return;
+
+    // Inputs are stored as runs of identical ticks, held directions make up most of a run
+    auto& runs = gReplayData.mRuns;
+    if (runs.empty() || runs.back().mInput != input || runs.back().mLength == UINT16_MAX)
+    {
+        runs.push_back(InputRun{ input, 0 });
+    }
+    runs.back().mLength++;
+    gReplayData.mTick++;
+}
+
+GameInput getReplayInput()
+{
+    auto& runs = gReplayData.mRuns;
+    while (gReplayData.mRunIndex < runs.size() && gReplayData.mRunPosition >= runs[gReplayData.mRunIndex].mLength)
+    {
+        gReplayData.mRunIndex++;
+        gReplayData.mRunPosition = 0;
+    }
+    if (gReplayData.mRunIndex >= runs.size())
+    {
+        finishReplay();
+        return 0;
+    }
+
+    gReplayData.mRunPosition++;
+    gReplayData.mTick++;
+    return runs[gReplayData.mRunIndex].mInput;
+}
+
+uint32_t hashReplayBytes(uint32_t hash, const void* data, size_t size)
+{
+    auto bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+bool isReplayHashTick()
+{
+    if (!isRecordingReplay() && !(gReplayData.mIsPlaying && !gReplayData.mIsFinished)) return false;
+    return gReplayData.mTick && !(gReplayData.mTick % REPLAY_HASH_INTERVAL);
+}
+
+void submitReplayStateHash(uint32_t hash)
+{
+    if (gReplayData.mIsRecording)
+    {
+        gReplayData.mHashes.push_back(hash);
+        return;
+    }
+
+    if (gReplayData.mHashIndex >= gReplayData.mHashes.size()) return;
+    if (gReplayData.mHashes[gReplayData.mHashIndex] != hash)
+    {
+        printf("Replay desync between tick %u and %u: expected state hash %08x, got %08x\n", gReplayData.mTick - REPLAY_HASH_INTERVAL, gReplayData.mTick, gReplayData.mHashes[gReplayData.mHashIndex], hash);
+        finishReplay();
+        return;
+    }
+    gReplayData.mHashIndex++;
+}
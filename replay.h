@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gameinput.h"
+
+#define REPLAY_HASH_BASIS 2166136261u
+
+bool parseReplayArguments(int argc, char** argv);
+bool isRecordingReplay();
+bool isPlayingReplay();
+
+uint32_t getReplaySeed();
+uint32_t startReplayRun();
+void startReplay();
+void finishReplay();
+
+void recordReplayInput(GameInput input);
+GameInput getReplayInput();
+
+uint32_t hashReplayBytes(uint32_t hash, const void* data, size_t size);
+bool isReplayHashTick();
+void submitReplayStateHash(uint32_t hash);
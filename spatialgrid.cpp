@@ -0,0 +1,155 @@
+#include "spatialgrid.h"
+
+SpatialGrid::SpatialGrid(double minX, double minY, double maxX, double maxY, double cellSize)
+    : mMinX(minX)
+    , mMinY(minY)
+    , mCellSize(cellSize)
+{
+    mColumns = max(1, int(ceil((maxX - minX) / cellSize)));
+    mRows = max(1, int(ceil((maxY - minY) / cellSize)));
+    mCells.resize(mColumns * mRows);
+}
+
+int SpatialGrid::getColumn(double x) const
+{
+    return std::clamp(int((x - mMinX) / mCellSize), 0, mColumns - 1);
+}
+
+int SpatialGrid::getRow(double y) const
+{
+    return std::clamp(int((y - mMinY) / mCellSize), 0, mRows - 1);
+}
+
+int SpatialGrid::getCellIndex(const Vector2D& pos) const
+{
+    return getRow(pos.y) * mColumns + getColumn(pos.x);
+}
+
+void SpatialGrid::addToCell(int id, int cell, const Vector2D& pos)
+{
+    mSlots[id] = Slot{ cell, int(mCells[cell].size()) };
+    mCells[cell].push_back(Entry{ id, pos });
+}
+
+void SpatialGrid::removeFromCell(int id)
+{
+    auto& slot = mSlots[id];
+    auto& cell = mCells[slot.cell];
+    cell[slot.index] = cell.back();
+    cell.pop_back();
+    if (slot.index < int(cell.size()))
+    {
+        mSlots[cell[slot.index].id].index = slot.index;
+    }
+}
+
+void SpatialGrid::insert(int id, const Vector2D& pos)
+{
+    if (id >= int(mSlots.size()))
+    {
+        mSlots.resize(id + 1);
+    }
+    addToCell(id, getCellIndex(pos), pos);
+}
+
+void SpatialGrid::move(int id, const Vector2D& newPos)
+{
+    auto& slot = mSlots[id];
+    int newCell = getCellIndex(newPos);
+    if (slot.cell != newCell)
+    {
+        removeFromCell(id);
+        addToCell(id, newCell, newPos);
+        return;
+    }
+
+    mCells[slot.cell][slot.index].pos = newPos;
+}
+
+void SpatialGrid::remove(int id)
+{
+    removeFromCell(id);
+    int lastId = int(mSlots.size()) - 1;
+    if (id != lastId)
+    {
+        auto& lastSlot = mSlots[lastId];
+        mCells[lastSlot.cell][lastSlot.index].id = id;
+        mSlots[id] = lastSlot;
+    }
+    mSlots.pop_back();
+}
+
+// Rings up to the given one are scanned, every other cell lies beyond one of the sides that do not touch the grid's border
+double SpatialGrid::getDistanceToUnscannedCells(const Vector2D& pos, int centerColumn, int centerRow, int ring) const
+{
+    double distance = INF;
+    if (centerColumn - ring > 0) distance = min(distance, pos.x - (mMinX + (centerColumn - ring) * mCellSize));
+    if (centerColumn + ring < mColumns - 1) distance = min(distance, mMinX + (centerColumn + ring + 1) * mCellSize - pos.x);
+    if (centerRow - ring > 0) distance = min(distance, pos.y - (mMinY + (centerRow - ring) * mCellSize));
+    if (centerRow + ring < mRows - 1) distance = min(distance, mMinY + (centerRow + ring + 1) * mCellSize - pos.y);
+    return distance;
+}
+
+int SpatialGrid::findNearest(const Vector2D& pos, double* outDistance) const
+{
+    int centerColumn = getColumn(pos.x);
+    int centerRow = getRow(pos.y);
+    int maxRing = max(mColumns, mRows);
+
+    int bestId = -1;
+    double bestDistance = INF;
+    for (int ring = 0; ring <= maxRing; ring++)
+    {
+        if (ring && bestId != -1 && bestDistance <= getDistanceToUnscannedCells(pos, centerColumn, centerRow, ring - 1)) break;
+
+        for (int row = centerRow - ring; row <= centerRow + ring; row++)
+        {
+            if (row < 0 || row >= mRows) continue;
+            bool isEdgeRow = (row == centerRow - ring) || (row == centerRow + ring);
+            int columnStep = isEdgeRow ? 1 : 2 * ring;
+            for (int column = centerColumn - ring; column <= centerColumn + ring; column += max(1, columnStep))
+            {
+                if (column < 0 || column >= mColumns) continue;
+                for (auto& entry : mCells[row * mColumns + column])
+                {
+                    auto dist = vecLength(entry.pos - pos);
+                    if (dist < bestDistance)
+                    {
+                        bestDistance = dist;
+                        bestId = entry.id;
+                    }
+                }
+            }
+        }
+    }
+
+    if (outDistance) *outDistance = bestDistance;
+    return bestId;
+}
+
+// Sum of pushes away from every other entry in range, each scaled from 1 when overlapping to 0 at the radius
+Vector2D SpatialGrid::getSeparation(int id, const Vector2D& pos, double radius) const
+{
+    Vector2D separation(0, 0);
+    int startColumn = getColumn(pos.x - radius);
+    int endColumn = getColumn(pos.x + radius);
+    int startRow = getRow(pos.y - radius);
+    int endRow = getRow(pos.y + radius);
+    for (int row = startRow; row <= endRow; row++)
+    {
+        for (int column = startColumn; column <= endColumn; column++)
+        {
+            for (auto& entry : mCells[row * mColumns + column])
+            {
+                if (entry.id == id) continue;
+                auto away = pos - entry.pos;
+                auto dist = vecLength(away);
+                if (dist >= radius) continue;
+                // Entries on the exact same spot get pushed apart along x, in id order so both do not pick the same side
+                auto direction = dist > 0 ? away * (1.0 / dist) : Vector2D(id < entry.id ? -1 : 1, 0);
+                separation = separation + direction * ((radius - dist) / radius);
+            }
+        }
+    }
+    return separation;
+}
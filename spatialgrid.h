@@ -0,0 +1,45 @@
+#pragma once
+
+#include <prism/blitz.h>
+
+// Ids are the dense indices of a swap and pop pool: insert appends the next index, remove moves the last index into the freed one
+class SpatialGrid
+{
+public:
+    SpatialGrid(double minX, double minY, double maxX, double maxY, double cellSize);
+
+    void insert(int id, const Vector2D& pos);
+    void move(int id, const Vector2D& newPos);
+    void remove(int id);
+
+    int findNearest(const Vector2D& pos, double* outDistance = nullptr) const;
+    Vector2D getSeparation(int id, const Vector2D& pos, double radius) const;
+
+private:
+    struct Entry
+    {
+        int id;
+        Vector2D pos;
+    };
+    struct Slot
+    {
+        int cell;
+        int index;
+    };
+
+    int getCellIndex(const Vector2D& pos) const;
+    int getColumn(double x) const;
+    int getRow(double y) const;
+    double getDistanceToUnscannedCells(const Vector2D& pos, int centerColumn, int centerRow, int ring) const;
+    void addToCell(int id, int cell, const Vector2D& pos);
+    void removeFromCell(int id);
+
+    double mMinX;
+    double mMinY;
+    double mCellSize;
+    int mColumns;
+    int mRows;
+    std::vector<std::vector<Entry>> mCells;
+    // Cell and position inside it for every id, so moves and removals do not search the cell
+    std::vector<Slot> mSlots;
+};
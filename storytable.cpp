@@ -0,0 +1,98 @@
+#include "storytable.h"
+
+#define STORY_TABLE_MAGIC 0x5359424A
+#define STORY_TABLE_VERSION 1
+#define STORY_TABLE_HEADER_SIZE 16
+#define STORY_TABLE_BOOK_ENTRY_SIZE 3
+#define STORY_TABLE_PAGE_ENTRY_SIZE 2
+
+// Only handed out if abortSystem returns, setTextActive skips it and it is the book's only page
+static const char gEmptyPage[] = "end";
+
+static void failStoryTable(StoryTable* table, const char* reason, const char* path)
+{
+    logErrorFormat("%s story table %s, rebuild it with tools/storycompiler.py", reason, path);
+    table->mHasBuffer = 0;
+    table->mBookAmount = 0;
+    abortSystem();
+}
+
+// Every offset has to land inside the blob and every string has to end before it does, so nothing read later can run past the buffer
+static bool isStoryTableInBounds(const StoryTable* table, uint32_t pageAmount, size_t blobSize)
+{
+    if (!blobSize || table->mBlob[blobSize - 1]) return false;
+    for (uint32_t i = 0; i < table->mBookAmount; i++)
+    {
+        auto entry = table->mBookIndex + i * STORY_TABLE_BOOK_ENTRY_SIZE;
+        if (entry[0] >= blobSize || !entry[2] || entry[1] > pageAmount || entry[2] > pageAmount - entry[1]) return false;
+    }
+    for (uint32_t i = 0; i < pageAmount; i++)
+    {
+        auto entry = table->mPageIndex + i * STORY_TABLE_PAGE_ENTRY_SIZE;
+        if (entry[0] >= blobSize || entry[1] >= blobSize - entry[0] || table->mBlob[entry[0] + entry[1]]) return false;
+    }
+    return true;
+}
+
+void loadStoryTable(StoryTable* table, const char* path)
+{
+    if (!isFile(path))
+    {
+        failStoryTable(table, "Missing", path);
+        return;
+    }
+
+    table->mBuffer = fileToBuffer(path);
+    auto header = (const uint32_t*)table->mBuffer.mData;
+    bool isValid = table->mBuffer.mLength >= STORY_TABLE_HEADER_SIZE && header[0] == STORY_TABLE_MAGIC && header[1] == STORY_TABLE_VERSION;
+    uint64_t blobStart = isValid ? STORY_TABLE_HEADER_SIZE + (uint64_t(header[2]) * STORY_TABLE_BOOK_ENTRY_SIZE + uint64_t(header[3]) * STORY_TABLE_PAGE_ENTRY_SIZE) * sizeof(uint32_t) : 0;
+    if (!isValid || blobStart > table->mBuffer.mLength)
+    {
+        freeBuffer(table->mBuffer);
+        failStoryTable(table, "Invalid", path);
+        return;
+    }
+
+    table->mBookAmount = header[2];
+    auto pageAmount = header[3];
+    table->mBookIndex = header + STORY_TABLE_HEADER_SIZE / sizeof(uint32_t);
+    table->mPageIndex = table->mBookIndex + table->mBookAmount * STORY_TABLE_BOOK_ENTRY_SIZE;
+    table->mBlob = (const char*)(table->mPageIndex + pageAmount * STORY_TABLE_PAGE_ENTRY_SIZE);
+    if (!isStoryTableInBounds(table, pageAmount, size_t(table->mBuffer.mLength - blobStart)))
+    {
+        freeBuffer(table->mBuffer);
+        failStoryTable(table, "Invalid", path);
+        return;
+    }
+    table->mHasBuffer = 1;
+}
+
+void unloadStoryTable(StoryTable* table)
+{
+    if (table->mHasBuffer)
+    {
+        freeBuffer(table->mBuffer);
+    }
+    table->mHasBuffer = 0;
+}
+
+StoryBook getStoryTableBook(const StoryTable* table, const std::string& name)
+{
+    for (uint32_t i = 0; i < table->mBookAmount; i++)
+    {
+        auto entry = table->mBookIndex + i * STORY_TABLE_BOOK_ENTRY_SIZE;
+        if (name != table->mBlob + entry[0]) continue;
+        return StoryBook{ table, entry[1], int(entry[2]) };
+    }
+
+    logErrorFormat("Story table has no book %s, rebuild it with tools/storycompiler.py", name.c_str());
+    abortSystem();
+    return StoryBook{ nullptr, 0, 1 };
+}
+
+const char* getStoryBookPage(const StoryBook& book, int page)
+{
+    if (!book.mTable) return gEmptyPage;
+    auto entry = book.mTable->mPageIndex + (book.mFirstPage + page) * STORY_TABLE_PAGE_ENTRY_SIZE;
+    return book.mTable->mBlob + entry[0];
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <prism/file.h>
+
+struct StoryTable
+{
+    Buffer mBuffer;
+    int mHasBuffer;
+    uint32_t mBookAmount;
+    const uint32_t* mBookIndex;
+    const uint32_t* mPageIndex;
+    const char* mBlob;
+};
+
+struct StoryBook
+{
+    const StoryTable* mTable;
+    uint32_t mFirstPage;
+    int mPageAmount;
+};
+
+// A missing or broken table is fatal, like WAVES.bin
+void loadStoryTable(StoryTable* table, const char* path);
+void unloadStoryTable(StoryTable* table);
+
+StoryBook getStoryTableBook(const StoryTable* table, const std::string& name);
+const char* getStoryBookPage(const StoryBook& book, int page);
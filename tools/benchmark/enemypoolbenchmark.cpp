@@ -0,0 +1,335 @@
+// Compares the per-frame enemy update on the old std::map<int, Enemy> against the game's structure-of-arrays EnemyPool (enemypool.cpp and actorstate.cpp are built in).
+// Blitz keeps entity positions and animation state in maps keyed by entity id, the fake blitz below does the same,
+// so both sides pay for the engine lookups they make: the map version several per enemy and step, the pool one snapshot and one write back.
+// Each frame one enemy dies and a new one spawns, so removal is measured as well.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include <prism/blitz.h>
+
+#include "../../enemypool.h"
+
+#define PLAY_AREA_MIN_Y 76.0
+#define PLAY_AREA_MAX_Y 171.0
+#define PLAY_AREA_MAX_X 320.0
+#define FRAME_AMOUNT 200
+
+struct FakeBlitzEntity
+{
+    Vector3D position;
+};
+
+struct FakeBlitzAnimation
+{
+    int animationNo;
+    int animationStep;
+    int remainingAnimationTime;
+    int isFacingRight;
+    double scale;
+};
+
+static struct
+{
+    std::map<int, FakeBlitzEntity> mEntities;
+    std::map<int, FakeBlitzAnimation> mAnimations;
+    int mNextId = 0;
+    std::mt19937 mRandom;
+} gBenchmarkData;
+
+static int addFakeEntity(const Vector2D& position)
+{
+    int id = gBenchmarkData.mNextId++;
+    gBenchmarkData.mEntities[id] = FakeBlitzEntity{ position.xyz(0) };
+    gBenchmarkData.mAnimations[id] = FakeBlitzAnimation{ 30, 0, 10, 1, 1.0 };
+    return id;
+}
+
+static void removeFakeEntity(int id)
+{
+    gBenchmarkData.mEntities.erase(id);
+    gBenchmarkData.mAnimations.erase(id);
+}
+
+static FakeBlitzEntity& getFakeEntity(int id) { return gBenchmarkData.mEntities.find(id)->second; }
+static FakeBlitzAnimation& getFakeAnimation(int id) { return gBenchmarkData.mAnimations.find(id)->second; }
+
+static void changeFakeAnimation(int id, int animationNo)
+{
+    auto& animation = getFakeAnimation(id);
+    animation.animationNo = animationNo;
+    animation.animationStep = 0;
+    animation.remainingAnimationTime = 10;
+}
+
+// The blitz calls actorstate.cpp makes, over the same maps the std::map version uses directly
+Vector3D getBlitzEntityPosition(int entityID) { return getFakeEntity(entityID).position; }
+Vector3D* getBlitzEntityPositionReference(int entityID) { return &getFakeEntity(entityID).position; }
+void changeBlitzMugenAnimation(int entityID, int animationNumber) { changeFakeAnimation(entityID, animationNumber); }
+int getBlitzMugenAnimationAnimationNumber(int entityID) { return getFakeAnimation(entityID).animationNo; }
+int getBlitzMugenAnimationAnimationStep(int entityID) { return getFakeAnimation(entityID).animationStep; }
+int getBlitzMugenAnimationRemainingAnimationTime(int entityID) { return getFakeAnimation(entityID).remainingAnimationTime; }
+int getBlitzMugenAnimationIsFacingRight(int entityID) { return getFakeAnimation(entityID).isFacingRight; }
+void setBlitzMugenAnimationBaseDrawScale(int entityID, double scale) { getFakeAnimation(entityID).scale = scale; }
+void setBlitzMugenAnimationFaceDirection(int entityID, int isFacingRight) { getFakeAnimation(entityID).isFacingRight = isFacingRight; }
+
+static Vector2D generateRandomPosition()
+{
+    std::uniform_real_distribution<double> x(20, 300);
+    std::uniform_real_distribution<double> y(PLAY_AREA_MIN_Y, PLAY_AREA_MAX_Y);
+    return Vector2D(x(gBenchmarkData.mRandom), y(gBenchmarkData.mRandom));
+}
+
+static Vector2D clampToPlayArea(const Vector2D& pos)
+{
+    return Vector2D(std::clamp(pos.x, 0.0, PLAY_AREA_MAX_X), std::clamp(pos.y, PLAY_AREA_MIN_Y, PLAY_AREA_MAX_Y));
+}
+
+static double yToZ(double y) { return 10 + 10 * (y - PLAY_AREA_MIN_Y) / (PLAY_AREA_MAX_Y - PLAY_AREA_MIN_Y); }
+static double yToScale(double y) { return 0.5 + 0.5 * (y - PLAY_AREA_MIN_Y) / (PLAY_AREA_MAX_Y - PLAY_AREA_MIN_Y); }
+
+static bool isBlocked(int animationNo)
+{
+    return (animationNo >= 32) && (animationNo <= 36);
+}
+
+// The update as it was before the pool, every step asks blitz again
+class MapEnemies
+{
+public:
+    struct Enemy
+    {
+        int entityId;
+        Vector2D target;
+        double speed;
+        int life;
+        bool isToBeDeleted;
+    };
+
+    void add()
+    {
+        int id = addFakeEntity(generateRandomPosition());
+        mEnemies[id] = Enemy{ id, generateRandomPosition(), 0.5, 1000, false };
+    }
+
+    void markOneForDeletion(int frame)
+    {
+        auto it = mEnemies.begin();
+        std::advance(it, frame % mEnemies.size());
+        it->second.isToBeDeleted = true;
+    }
+
+    void update(const Vector2D& playerPos)
+    {
+        updateClosestEnemy(playerPos);
+        auto it = mEnemies.begin();
+        while (it != mEnemies.end())
+        {
+            if (it->second.isToBeDeleted)
+            {
+                removeFakeEntity(it->second.entityId);
+                it = mEnemies.erase(it);
+            }
+            else
+            {
+                updateSingleEnemy(it->second, playerPos);
+                it++;
+            }
+        }
+    }
+
+    size_t size() const { return mEnemies.size(); }
+
+private:
+    std::map<int, Enemy> mEnemies;
+    int mClosestEnemyEntity = -1;
+
+    void updateClosestEnemy(const Vector2D& playerPos)
+    {
+        double closestDistance = INF;
+        for (auto& enemy : mEnemies)
+        {
+            auto dist = vecLength(getFakeEntity(enemy.second.entityId).position.xy() - playerPos);
+            if (dist < closestDistance)
+            {
+                closestDistance = dist;
+                mClosestEnemyEntity = enemy.second.entityId;
+            }
+        }
+    }
+
+    void updateSingleEnemy(Enemy& e, const Vector2D& playerPos)
+    {
+        auto target = e.entityId == mClosestEnemyEntity ? playerPos : e.target;
+        if (!isBlocked(getFakeAnimation(e.entityId).animationNo))
+        {
+            auto& entity = getFakeEntity(e.entityId);
+            auto dir = target - entity.position.xy();
+            if (vecLength(dir) < e.speed * 2)
+            {
+                if (getFakeAnimation(e.entityId).animationNo != 30) changeFakeAnimation(e.entityId, 30);
+                e.target = generateRandomPosition();
+            }
+            else
+            {
+                if (getFakeAnimation(e.entityId).animationNo != 31) changeFakeAnimation(e.entityId, 31);
+                auto pos = clampToPlayArea(entity.position.xy() + vecNormalize(dir) * e.speed);
+                entity.position = pos.xyz(yToZ(pos.y));
+                getFakeAnimation(e.entityId).scale = yToScale(pos.y);
+            }
+        }
+
+        auto animationNo = getFakeAnimation(e.entityId).animationNo;
+        if (isBlocked(animationNo) && animationNo != 36 && !getFakeAnimation(e.entityId).remainingAnimationTime)
+        {
+            changeFakeAnimation(e.entityId, 30);
+        }
+
+        animationNo = getFakeAnimation(e.entityId).animationNo;
+        if (animationNo == 30 || animationNo == 31)
+        {
+            getFakeAnimation(e.entityId).isFacingRight = int(getFakeEntity(e.entityId).position.x < playerPos.x);
+        }
+
+        if (!e.life && getFakeAnimation(e.entityId).animationNo != 36)
+        {
+            changeFakeAnimation(e.entityId, 36);
+        }
+    }
+};
+
+// The game's EnemyPool and ActorState, blitz state is snapshot once into the pool and dirty values are written back once
+class PoolEnemies
+{
+public:
+    void add()
+    {
+        auto pos = generateRandomPosition();
+        int id = addFakeEntity(pos);
+        mEnemies.add(id, pos, generateRandomPosition(), 0.5, 1000, 30, -1, -1, false);
+    }
+
+    void markOneForDeletion(int frame)
+    {
+        mEnemies.isToBeDeleted[frame % mEnemies.size()] = 1;
+    }
+
+    void update(const Vector2D& playerPos)
+    {
+        removeDeleted();
+        snapshotActorStates(mEnemies.states.data(), mEnemies.size());
+        updateClosestEnemy(playerPos);
+        for (size_t i = 0; i < mEnemies.size(); i++)
+        {
+            updateSingleEnemy(i, playerPos);
+        }
+        writeBackActorStates(mEnemies.states.data(), mEnemies.size());
+    }
+
+    size_t size() const { return mEnemies.size(); }
+
+private:
+    EnemyPool mEnemies;
+    int mClosestEnemyIndex = -1;
+
+    void removeDeleted()
+    {
+        size_t i = mEnemies.size();
+        while (i--)
+        {
+            if (!mEnemies.isToBeDeleted[i]) continue;
+            removeFakeEntity(mEnemies.entityIds[i]);
+            mEnemies.removeAt(i);
+        }
+    }
+
+    void updateClosestEnemy(const Vector2D& playerPos)
+    {
+        double closestDistance = INF;
+        for (size_t i = 0; i < mEnemies.size(); i++)
+        {
+            auto dist = vecLength(mEnemies.states[i].mPosition.xy() - playerPos);
+            if (dist < closestDistance)
+            {
+                closestDistance = dist;
+                mClosestEnemyIndex = int(i);
+            }
+        }
+    }
+
+    void updateSingleEnemy(size_t i, const Vector2D& playerPos)
+    {
+        auto& state = mEnemies.states[i];
+        auto target = int(i) == mClosestEnemyIndex ? playerPos : mEnemies.targets[i];
+        if (!isBlocked(state.mAnimationNo))
+        {
+            auto pos = state.mPosition.xy();
+            auto dir = target - pos;
+            if (vecLength(dir) < mEnemies.speeds[i] * 2)
+            {
+                changeActorAnimationIfDifferent(&state, 30);
+                mEnemies.targets[i] = generateRandomPosition();
+            }
+            else
+            {
+                changeActorAnimationIfDifferent(&state, 31);
+                pos = clampToPlayArea(pos + vecNormalize(dir) * mEnemies.speeds[i]);
+                setActorPosition(&state, pos.xyz(yToZ(pos.y)));
+                setActorScale(&state, yToScale(pos.y));
+            }
+        }
+
+        if (isBlocked(state.mAnimationNo) && state.mAnimationNo != 36 && !state.mRemainingAnimationTime)
+        {
+            changeActorAnimation(&state, 30);
+        }
+
+        if (state.mAnimationNo == 30 || state.mAnimationNo == 31)
+        {
+            setActorFaceDirection(&state, int(state.mPosition.x < playerPos.x));
+        }
+
+        if (!mEnemies.lifes[i] && state.mAnimationNo != 36)
+        {
+            changeActorAnimation(&state, 36);
+        }
+    }
+};
+
+template<typename Enemies>
+static double measureNanosecondsPerFrame(int amount)
+{
+    gBenchmarkData.mEntities.clear();
+    gBenchmarkData.mAnimations.clear();
+    gBenchmarkData.mRandom.seed(amount);
+    Enemies enemies;
+    for (int i = 0; i < amount; i++)
+    {
+        enemies.add();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAME_AMOUNT; frame++)
+    {
+        auto playerPos = Vector2D(160 + 100 * sin(frame * 0.05), 120 + 40 * cos(frame * 0.07));
+        enemies.markOneForDeletion(frame);
+        enemies.update(playerPos);
+        enemies.add();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / FRAME_AMOUNT;
+}
+
+int main()
+{
+    printf("ns per frame, std::map / pool\n");
+    int amounts[] = { 10, 1000, 10000 };
+    for (auto amount : amounts)
+    {
+        auto mapTime = measureNanosecondsPerFrame<MapEnemies>(amount);
+        auto poolTime = measureNanosecondsPerFrame<PoolEnemies>(amount);
+        printf("%6d enemies  %10.0f / %10.0f  %5.2fx\n", amount, mapTime, poolTime, mapTime / poolTime);
+    }
+    return 0;
+}
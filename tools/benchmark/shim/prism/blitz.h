@@ -0,0 +1,68 @@
+#pragma once
+
+// Stand-in for the few prism math helpers the engine-free game modules use, so they build for the benchmarks without the engine.
+// The blitz entity and animation calls are only declared, each benchmark that builds a module using them defines them over its own fake state.
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define INF 1000000000
+
+using std::max;
+using std::min;
+
+struct Vector3D;
+
+struct Vector2D
+{
+    double x = 0;
+    double y = 0;
+
+    Vector2D() {}
+    Vector2D(double x, double y) : x(x), y(y) {}
+
+    Vector2D operator+(const Vector2D& other) const { return Vector2D(x + other.x, y + other.y); }
+    Vector2D operator-(const Vector2D& other) const { return Vector2D(x - other.x, y - other.y); }
+    Vector2D operator*(double factor) const { return Vector2D(x * factor, y * factor); }
+    Vector3D xyz(double z) const;
+};
+
+struct Vector3D
+{
+    double x = 0;
+    double y = 0;
+    double z = 0;
+
+    Vector3D() {}
+    Vector3D(double x, double y, double z) : x(x), y(y), z(z) {}
+
+    Vector2D xy() const { return Vector2D(x, y); }
+};
+
+inline Vector3D Vector2D::xyz(double z) const { return Vector3D(x, y, z); }
+
+inline double vecLength(const Vector2D& v)
+{
+    return sqrt(v.x * v.x + v.y * v.y);
+}
+
+inline Vector2D vecNormalize(const Vector2D& v)
+{
+    auto length = vecLength(v);
+    return length > 0 ? v * (1.0 / length) : v;
+}
+
+Vector3D getBlitzEntityPosition(int entityID);
+Vector3D* getBlitzEntityPositionReference(int entityID);
+
+void changeBlitzMugenAnimation(int entityID, int animationNumber);
+int getBlitzMugenAnimationAnimationNumber(int entityID);
+int getBlitzMugenAnimationAnimationStep(int entityID);
+int getBlitzMugenAnimationRemainingAnimationTime(int entityID);
+int getBlitzMugenAnimationIsFacingRight(int entityID);
+void setBlitzMugenAnimationBaseDrawScale(int entityID, double scale);
+void setBlitzMugenAnimationFaceDirection(int entityID, int isFacingRight);
@@ -0,0 +1,252 @@
+// Compares SpatialGrid against linear scans on the calls GameScreen makes every frame.
+// All enemies take a small step (the grid has to follow them), one enemy dies and one spawns the way the swap and pop pool does it,
+// the player looks up its closest enemy and every enemy sums its crowd separation within 12px.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "../../spatialgrid.h"
+
+#define PLAY_AREA_MIN_Y 76.0
+#define PLAY_AREA_MAX_Y 171.0
+#define PLAY_AREA_MAX_X 320.0
+#define SEPARATION_RADIUS 12.0
+#define FRAME_AMOUNT 200
+
+struct BenchmarkEnemies
+{
+    std::vector<Vector2D> positions;
+    std::vector<Vector2D> steps;
+};
+
+struct BenchmarkTimes
+{
+    double update = 0;
+    double nearest = 0;
+    double separation = 0;
+};
+
+static Vector2D makeRandomPosition(std::mt19937& random)
+{
+    std::uniform_real_distribution<double> x(0, PLAY_AREA_MAX_X);
+    std::uniform_real_distribution<double> y(PLAY_AREA_MIN_Y, PLAY_AREA_MAX_Y);
+    return Vector2D(x(random), y(random));
+}
+
+static Vector2D makeRandomStep(std::mt19937& random)
+{
+    std::uniform_real_distribution<double> step(-0.5, 0.5);
+    return Vector2D(step(random), step(random));
+}
+
+static BenchmarkEnemies makeEnemies(int amount, std::mt19937& random)
+{
+    BenchmarkEnemies enemies;
+    for (int i = 0; i < amount; i++)
+    {
+        enemies.positions.push_back(makeRandomPosition(random));
+        enemies.steps.push_back(makeRandomStep(random));
+    }
+    return enemies;
+}
+
+static Vector2D stepEnemy(const BenchmarkEnemies& enemies, size_t i)
+{
+    auto pos = enemies.positions[i] + enemies.steps[i];
+    return Vector2D(std::clamp(pos.x, 0.0, PLAY_AREA_MAX_X), std::clamp(pos.y, PLAY_AREA_MIN_Y, PLAY_AREA_MAX_Y));
+}
+
+template<typename T>
+static void swapAndPop(std::vector<T>& v, size_t i)
+{
+    v[i] = v.back();
+    v.pop_back();
+}
+
+static Vector2D getPlayerPosition(int frame)
+{
+    return Vector2D(160 + 100 * sin(frame * 0.05), 120 + 40 * cos(frame * 0.07));
+}
+
+static double getNanosecondsSince(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+class LinearSearch
+{
+public:
+    LinearSearch(const BenchmarkEnemies& enemies) : mEnemies(enemies) {}
+
+    void update()
+    {
+        for (size_t i = 0; i < mEnemies.positions.size(); i++)
+        {
+            mEnemies.positions[i] = stepEnemy(mEnemies, i);
+        }
+    }
+
+    void respawn(size_t i, const Vector2D& pos, const Vector2D& step)
+    {
+        swapAndPop(mEnemies.positions, i);
+        swapAndPop(mEnemies.steps, i);
+        mEnemies.positions.push_back(pos);
+        mEnemies.steps.push_back(step);
+    }
+
+    int findNearest(const Vector2D& pos) const
+    {
+        int bestId = -1;
+        double bestDistance = INF;
+        for (size_t i = 0; i < mEnemies.positions.size(); i++)
+        {
+            auto dist = vecLength(mEnemies.positions[i] - pos);
+            if (dist < bestDistance)
+            {
+                bestDistance = dist;
+                bestId = int(i);
+            }
+        }
+        return bestId;
+    }
+
+    Vector2D getSeparation(int id, const Vector2D& pos, double radius) const
+    {
+        Vector2D separation(0, 0);
+        for (size_t i = 0; i < mEnemies.positions.size(); i++)
+        {
+            if (int(i) == id) continue;
+            auto away = pos - mEnemies.positions[i];
+            auto dist = vecLength(away);
+            if (dist >= radius) continue;
+            auto direction = dist > 0 ? away * (1.0 / dist) : Vector2D(id < int(i) ? -1 : 1, 0);
+            separation = separation + direction * ((radius - dist) / radius);
+        }
+        return separation;
+    }
+
+    const BenchmarkEnemies& getEnemies() const { return mEnemies; }
+
+private:
+    BenchmarkEnemies mEnemies;
+};
+
+class GridSearch
+{
+public:
+    GridSearch(const BenchmarkEnemies& enemies) : mEnemies(enemies), mGrid(0, PLAY_AREA_MIN_Y, PLAY_AREA_MAX_X, PLAY_AREA_MAX_Y, 24)
+    {
+        for (size_t i = 0; i < mEnemies.positions.size(); i++)
+        {
+            mGrid.insert(int(i), mEnemies.positions[i]);
+        }
+    }
+
+    void update()
+    {
+        for (size_t i = 0; i < mEnemies.positions.size(); i++)
+        {
+            auto newPos = stepEnemy(mEnemies, i);
+            mGrid.move(int(i), newPos);
+            mEnemies.positions[i] = newPos;
+        }
+    }
+
+    void respawn(size_t i, const Vector2D& pos, const Vector2D& step)
+    {
+        mGrid.remove(int(i));
+        swapAndPop(mEnemies.positions, i);
+        swapAndPop(mEnemies.steps, i);
+        mEnemies.positions.push_back(pos);
+        mEnemies.steps.push_back(step);
+        mGrid.insert(int(mEnemies.positions.size() - 1), pos);
+    }
+
+    int findNearest(const Vector2D& pos) const { return mGrid.findNearest(pos); }
+    Vector2D getSeparation(int id, const Vector2D& pos, double radius) const { return mGrid.getSeparation(id, pos, radius); }
+    const BenchmarkEnemies& getEnemies() const { return mEnemies; }
+
+private:
+    BenchmarkEnemies mEnemies;
+    SpatialGrid mGrid;
+};
+
+// Sums of every result, the linear scan and the grid have to agree on them
+struct BenchmarkResults
+{
+    long long nearest = 0;
+    double separation = 0;
+
+    bool operator==(const BenchmarkResults& other) const
+    {
+        return nearest == other.nearest && fabs(separation - other.separation) < 1e-6 * max(1.0, fabs(separation));
+    }
+};
+
+template<typename Search>
+static BenchmarkTimes measure(Search& search, int seed, BenchmarkResults& results)
+{
+    std::mt19937 random(seed);
+    BenchmarkTimes times;
+    for (int frame = 0; frame < FRAME_AMOUNT; frame++)
+    {
+        auto dyingIndex = random() % search.getEnemies().positions.size();
+        auto spawnPos = makeRandomPosition(random);
+        auto spawnStep = makeRandomStep(random);
+        auto start = std::chrono::steady_clock::now();
+        search.update();
+        search.respawn(dyingIndex, spawnPos, spawnStep);
+        times.update += getNanosecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        results.nearest += search.findNearest(getPlayerPosition(frame));
+        times.nearest += getNanosecondsSince(start);
+
+        auto& positions = search.getEnemies().positions;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            auto separation = search.getSeparation(int(i), positions[i], SEPARATION_RADIUS);
+            results.separation += separation.x + separation.y;
+        }
+        times.separation += getNanosecondsSince(start);
+    }
+
+    times.update /= FRAME_AMOUNT;
+    times.nearest /= FRAME_AMOUNT;
+    times.separation /= FRAME_AMOUNT;
+    return times;
+}
+
+static void runBenchmark(int amount)
+{
+    std::mt19937 random(amount);
+    auto enemies = makeEnemies(amount, random);
+
+    BenchmarkResults linearResults;
+    LinearSearch linear(enemies);
+    auto linearTimes = measure(linear, amount, linearResults);
+
+    BenchmarkResults gridResults;
+    GridSearch grid(enemies);
+    auto gridTimes = measure(grid, amount, gridResults);
+
+    printf("%6d enemies  update %9.0f / %9.0f  closest enemy %8.0f / %8.0f  separation %12.0f / %10.0f%s\n", amount,
+        linearTimes.update, gridTimes.update,
+        linearTimes.nearest, gridTimes.nearest,
+        linearTimes.separation, gridTimes.separation,
+        linearResults == gridResults ? "" : "  RESULTS DIFFER");
+}
+
+int main()
+{
+    printf("ns per frame, linear scan / grid\n");
+    int amounts[] = { 10, 100, 1000, 10000 };
+    for (auto amount : amounts)
+    {
+        runBenchmark(amount);
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+# Moves a range of sprite groups out of an SFF v2 file into a second SFF, so art that is only shown
+# on rare occasions can be loaded when it is needed instead of with the rest of the screen.
+#
+# usage: sffsplit.py SOURCE.sff KEPT.sff MOVED.sff FIRST_GROUP LAST_GROUP
+#
+# Linked sprites are remapped, a link that would cross the two outputs is resolved by copying the data.
+import struct
+import sys
+
+HEADER_SPRITE_LIST = 0x24
+SPRITE_NODE_FORMAT = "<HHHHhhHBBIIHH"
+SPRITE_NODE_SIZE = struct.calcsize(SPRITE_NODE_FORMAT)
+PALETTE_NODE_FORMAT = "<HHHHII"
+PALETTE_NODE_SIZE = struct.calcsize(PALETTE_NODE_FORMAT)
+FLAG_TDATA = 1
+
+
+def read_sff(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if not data.startswith(b"ElecbyteSpr\0") or data[15] != 2:
+        raise ValueError(path + " is not an SFF v2 file")
+    sprite_offset, sprite_amount, palette_offset, palette_amount, ldata_offset, ldata_length, tdata_offset, tdata_length = \
+        struct.unpack_from("<IIIIIIII", data, HEADER_SPRITE_LIST)
+
+    sprites = []
+    for i in range(sprite_amount):
+        node = list(struct.unpack_from(SPRITE_NODE_FORMAT, data, sprite_offset + i * SPRITE_NODE_SIZE))
+        sprites.append(node)
+    palettes = [data[palette_offset + i * PALETTE_NODE_SIZE:palette_offset + (i + 1) * PALETTE_NODE_SIZE] for i in range(palette_amount)]
+    return {
+        "header": data[:sprite_offset],
+        "sprites": sprites,
+        "palettes": palettes,
+        "ldata": data[ldata_offset:ldata_offset + ldata_length],
+        "tdata": data[tdata_offset:tdata_offset + tdata_length],
+    }
+
+
+def get_sprite_data(sff, node):
+    offset, length, flags = node[9], node[10], node[12]
+    block = sff["tdata"] if flags & FLAG_TDATA else sff["ldata"]
+    return block[offset:offset + length]
+
+
+def resolve_link(sff, index):
+    node = sff["sprites"][index]
+    while node[10] == 0 and node[6] != index:
+        index = node[6]
+        node = sff["sprites"][index]
+    return index
+
+
+def write_sff(path, sff, indices):
+    remap = {old: new for new, old in enumerate(indices)}
+    ldata = bytearray()
+    tdata = bytearray()
+    nodes = bytearray()
+
+    # Both outputs keep every palette, their data lives in ldata, so it is copied ahead of the sprites
+    palette_nodes = bytearray()
+    for palette in sff["palettes"]:
+        node = list(struct.unpack(PALETTE_NODE_FORMAT, palette))
+        offset, length = node[4], node[5]
+        if length:
+            node[4] = len(ldata)
+            ldata += sff["ldata"][offset:offset + length]
+        palette_nodes += struct.pack(PALETTE_NODE_FORMAT, *node)
+    for old in indices:
+        node = list(sff["sprites"][old])
+        if node[10] == 0:
+            target = resolve_link(sff, old)
+            if target in remap and target != old:
+                node[6] = remap[target]
+                nodes += struct.pack(SPRITE_NODE_FORMAT, *node)
+                continue
+            # The data ends up in the other file, so this sprite gets its own copy
+            node[7:] = sff["sprites"][target][7:]
+
+        sprite_data = get_sprite_data(sff, node)
+        block = tdata if node[12] & FLAG_TDATA else ldata
+        node[6] = 0
+        node[9] = len(block)
+        node[10] = len(sprite_data)
+        block += sprite_data
+        nodes += struct.pack(SPRITE_NODE_FORMAT, *node)
+
+    palette_block = bytes(palette_nodes)
+    sprite_offset = len(sff["header"])
+    palette_offset = sprite_offset + len(nodes)
+    ldata_offset = palette_offset + len(palette_block)
+    tdata_offset = ldata_offset + len(ldata)
+
+    header = bytearray(sff["header"])
+    struct.pack_into("<IIIIIIII", header, HEADER_SPRITE_LIST,
+                     sprite_offset, len(indices), palette_offset, len(sff["palettes"]),
+                     ldata_offset, len(ldata), tdata_offset, len(tdata))
+    with open(path, "wb") as f:
+        f.write(header + nodes + palette_block + ldata + tdata)
+
+
+def main():
+    if len(sys.argv) != 6:
+        print("usage: sffsplit.py SOURCE.sff KEPT.sff MOVED.sff FIRST_GROUP LAST_GROUP")
+        return 1
+    sff = read_sff(sys.argv[1])
+    first_group, last_group = int(sys.argv[4]), int(sys.argv[5])
+    moved = [i for i, node in enumerate(sff["sprites"]) if first_group <= node[0] <= last_group]
+    kept = [i for i in range(len(sff["sprites"])) if i not in moved]
+    write_sff(sys.argv[2], sff, kept)
+    write_sff(sys.argv[3], sff, moved)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
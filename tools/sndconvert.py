@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# Rewrites an SND v1 sound bank with every clip converted to 16 bit PCM at the given rate, keeping
+# its channels unless --mono downmixes them, optionally restricted to a range of groups, so one
+# bank can be split into parts that are converted differently.
+#
+# usage: sndconvert.py SOURCE.snd OUTPUT.snd [--rate 44100] [--mono] [--groups FIRST-LAST]
+import argparse
+import math
+import operator
+import struct
+import sys
+
+SUBFILE_HEADER_SIZE = 16
+# Filter length per polyphase branch, enough for a few kHz of transition band below the target Nyquist
+TAPS_PER_PHASE = 64
+
+
+def read_snd(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if not data.startswith(b"ElecbyteSnd\0"):
+        raise ValueError(path + " is not an SND file")
+    amount, offset = struct.unpack_from("<II", data, 16)
+    clips = []
+    for _ in range(amount):
+        next_offset, length, group, item = struct.unpack_from("<IIII", data, offset)
+        start = offset + SUBFILE_HEADER_SIZE
+        clips.append((group, item, data[start:start + length]))
+        offset = next_offset
+    return data[:struct.unpack_from("<I", data, 20)[0]], clips
+
+
+def read_wav(wav):
+    if wav[:4] != b"RIFF" or wav[8:12] != b"WAVE":
+        raise ValueError("clip is not a WAV file")
+    offset = 12
+    fmt = None
+    samples = None
+    while offset + 8 <= len(wav):
+        chunk_id, chunk_size = struct.unpack_from("<4sI", wav, offset)
+        body = wav[offset + 8:offset + 8 + chunk_size]
+        if chunk_id == b"fmt ":
+            fmt = struct.unpack_from("<HHIIHH", body)
+        elif chunk_id == b"data":
+            samples = body
+        offset += 8 + chunk_size + (chunk_size & 1)
+    if fmt is None or samples is None:
+        raise ValueError("clip is missing fmt or data")
+    audio_format, channels, rate, _, _, bits = fmt
+    if audio_format != 1 or bits != 16:
+        raise ValueError("only 16 bit PCM clips are supported")
+    frames = len(samples) // (2 * channels)
+    values = struct.unpack("<%dh" % (frames * channels), samples[:frames * channels * 2])
+    return rate, [list(values[c::channels]) for c in range(channels)]
+
+
+def make_polyphase_filter(up, down):
+    # Blackman windowed sinc low-pass at the upsampled rate, cut off below the lower of the two Nyquist rates
+    length = up * TAPS_PER_PHASE
+    center = (length - 1) / 2
+    cutoff = 0.5 / max(up, down) * 0.9
+    taps = []
+    for n in range(length):
+        x = n - center
+        sinc = 2 * cutoff if x == 0 else math.sin(2 * math.pi * cutoff * x) / (math.pi * x)
+        window = 0.42 - 0.5 * math.cos(2 * math.pi * n / (length - 1)) + 0.08 * math.cos(4 * math.pi * n / (length - 1))
+        taps.append(sinc * window)
+
+    # Branch p holds every up-th tap starting at p, reversed so it lines up with a forward slice of the input.
+    # Each branch is normalised on its own so no phase changes the DC level.
+    phases = []
+    for p in range(up):
+        branch = taps[p::up]
+        gain = sum(branch)
+        phases.append([tap / gain for tap in reversed(branch)])
+    return phases, int(center)
+
+
+def resample(channel, source_rate, target_rate):
+    if source_rate == target_rate:
+        return channel
+    # Polyphase resampling by the reduced ratio, 48k to 44.1k is 147/160
+    divisor = math.gcd(source_rate, target_rate)
+    up = target_rate // divisor
+    down = source_rate // divisor
+    phases, delay = make_polyphase_filter(up, down)
+
+    padding = TAPS_PER_PHASE
+    padded = [0] * padding + channel + [0] * padding
+    length = len(channel) * up // down
+    result = []
+    for i in range(length):
+        position = i * down + delay
+        phase = position % up
+        last = position // up + padding
+        value = sum(map(operator.mul, padded[last - TAPS_PER_PHASE + 1:last + 1], phases[phase]))
+        result.append(max(-32768, min(32767, int(round(value)))))
+    return result
+
+
+def write_wav(rate, channels):
+    frames = len(channels[0])
+    interleaved = [channels[c][i] for i in range(frames) for c in range(len(channels))]
+    samples = struct.pack("<%dh" % len(interleaved), *interleaved)
+    block_align = 2 * len(channels)
+    fmt = struct.pack("<HHIIHH", 1, len(channels), rate, rate * block_align, block_align, 16)
+    body = b"WAVE" + b"fmt " + struct.pack("<I", len(fmt)) + fmt + b"data" + struct.pack("<I", len(samples)) + samples
+    return b"RIFF" + struct.pack("<I", len(body)) + body
+
+
+def convert_clip(wav, target_rate, is_mono):
+    rate, channels = read_wav(wav)
+    is_downmixed = is_mono and len(channels) > 1
+    if rate == target_rate and not is_downmixed:
+        return wav
+    if is_downmixed:
+        # Averaged before resampling, so the filter only runs once per clip
+        channels = [[int(round(sum(values) / len(values))) for values in zip(*channels)]]
+    return write_wav(target_rate, [resample(channel, rate, target_rate) for channel in channels])
+
+
+def write_snd(path, header, clips):
+    header = bytearray(header)
+    offset = len(header)
+    body = bytearray()
+    for group, item, wav in clips:
+        next_offset = offset + SUBFILE_HEADER_SIZE + len(wav)
+        body += struct.pack("<IIII", next_offset, len(wav), group, item) + wav
+        offset = next_offset
+    struct.pack_into("<II", header, 16, len(clips), len(header))
+    with open(path, "wb") as f:
+        f.write(header + body)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("source")
+    parser.add_argument("output")
+    parser.add_argument("--rate", type=int, default=44100)
+    parser.add_argument("--mono", action="store_true")
+    parser.add_argument("--groups", default="0-65535")
+    args = parser.parse_args()
+
+    first_group, last_group = (int(value) for value in args.groups.split("-"))
+    header, clips = read_snd(args.source)
+    clips = [(group, item, convert_clip(wav, args.rate, args.mono)) for group, item, wav in clips if first_group <= group <= last_group]
+    write_snd(args.output, header, clips)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
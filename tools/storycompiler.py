@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+# Compiles STORY.def into the flat string table BookScreen reads at runtime.
+#
+# Layout (little endian, u32 unless noted):
+#   magic "JBYS", version, book amount, page amount
+#   book index: name offset, first page, page amount
+#   page index: text offset, text length
+#   blob: NUL-terminated names and page texts
+import struct
+import sys
+
+MAGIC = b"JBYS"
+VERSION = 1
+
+
+def parse_story(path):
+    books = []
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith(";"):
+                continue
+            if line.startswith("[") and line.endswith("]"):
+                books.append((line[1:-1].strip().lower(), []))
+                continue
+            if not books or ":" not in line:
+                continue
+            text = line.split(":", 1)[1].strip()
+            if len(text) >= 2 and text.startswith('"') and text.endswith('"'):
+                text = text[1:-1]
+            books[-1][1].append(text)
+    return books
+
+
+def compile_story(books):
+    blob = bytearray()
+
+    def add_string(text):
+        offset = len(blob)
+        blob.extend(text.encode("utf-8") + b"\0")
+        return offset
+
+    book_index = bytearray()
+    page_index = bytearray()
+    page_amount = 0
+    for name, pages in books:
+        book_index += struct.pack("<III", add_string(name), page_amount, len(pages))
+        for text in pages:
+            page_index += struct.pack("<II", add_string(text), len(text.encode("utf-8")))
+        page_amount += len(pages)
+
+    header = MAGIC + struct.pack("<III", VERSION, len(books), page_amount)
+    return header + book_index + page_index + blob
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("usage: storycompiler.py STORY.def STORY.bin")
+        return 1
+    with open(sys.argv[2], "wb") as f:
+        f.write(compile_story(parse_story(sys.argv[1])))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+# Compiles WAVES.def into the flat wave table GameScreen reads at runtime.
+#
+# Layout (little endian):
+#   magic "JBYW", u32 version, u32 wave amount, u32 wave entry size
+#   per wave: i32 enemy amount, i32 spawn batch, i32 spawn interval, i32 enemy type,
+#             f32 speed, i32 chaser amount, i64 life, i64 strength, i64 love gain
+import struct
+import sys
+
+MAGIC = b"JBYW"
+VERSION = 1
+WAVE_FORMAT = "<iiiifiqqq"
+
+DEFAULTS = {
+    "enemies": "10",
+    "spawnbatch": "1",
+    "spawninterval": "0",
+    "type": "0",
+    "speed": "0.5",
+    "chasers": "0",
+    "life": "1000",
+    "strength": "100",
+    "love": "10",
+}
+
+
+def parse_waves(path):
+    waves = []
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.split(";", 1)[0].strip()
+            if not line:
+                continue
+            if line.startswith("[") and line.endswith("]"):
+                waves.append(dict(DEFAULTS))
+                continue
+            if not waves or "=" not in line:
+                continue
+            key, value = line.split("=", 1)
+            key = key.strip().lower()
+            if key not in DEFAULTS:
+                raise ValueError("unknown wave key: " + key)
+            waves[-1][key] = value.strip()
+    return waves
+
+
+def compile_waves(waves):
+    entries = bytearray()
+    for wave in waves:
+        entries += struct.pack(WAVE_FORMAT,
+                               int(wave["enemies"]),
+                               max(1, int(wave["spawnbatch"])),
+                               int(wave["spawninterval"]),
+                               int(wave["type"]),
+                               float(wave["speed"]),
+                               max(0, int(wave["chasers"])),
+                               int(wave["life"]),
+                               int(wave["strength"]),
+                               int(wave["love"]))
+    header = MAGIC + struct.pack("<III", VERSION, len(waves), struct.calcsize(WAVE_FORMAT))
+    return header + entries
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("usage: wavecompiler.py WAVES.def WAVES.bin")
+        return 1
+    with open(sys.argv[2], "wb") as f:
+        f.write(compile_waves(parse_waves(sys.argv[1])))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
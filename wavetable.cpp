@@ -0,0 +1,54 @@
+#include "wavetable.h"
+
+#define WAVE_TABLE_MAGIC 0x5759424A
+#define WAVE_TABLE_VERSION 1
+#define WAVE_TABLE_HEADER_SIZE 16
+
+// Only handed out if abortSystem returns, so a broken table never gets indexed
+static const WaveDefinition gEmptyWave = {};
+
+static void failWaveTable(WaveTable* table, const char* reason, const char* path)
+{
+    logErrorFormat("%s wave table %s, rebuild it with tools/wavecompiler.py", reason, path);
+    table->mHasBuffer = 0;
+    table->mWaveAmount = 1;
+    table->mWaves = &gEmptyWave;
+    abortSystem();
+}
+
+void loadWaveTable(WaveTable* table, const char* path)
+{
+    if (!isFile(path))
+    {
+        failWaveTable(table, "Missing", path);
+        return;
+    }
+
+    table->mBuffer = fileToBuffer(path);
+    auto header = (const uint32_t*)table->mBuffer.mData;
+    bool isValid = table->mBuffer.mLength >= WAVE_TABLE_HEADER_SIZE && header[0] == WAVE_TABLE_MAGIC && header[1] == WAVE_TABLE_VERSION && header[2] && header[3] == sizeof(WaveDefinition);
+    if (!isValid || table->mBuffer.mLength < WAVE_TABLE_HEADER_SIZE + header[2] * sizeof(WaveDefinition))
+    {
+        freeBuffer(table->mBuffer);
+        failWaveTable(table, "Invalid", path);
+        return;
+    }
+
+    table->mHasBuffer = 1;
+    table->mWaveAmount = header[2];
+    table->mWaves = (const WaveDefinition*)((const char*)table->mBuffer.mData + WAVE_TABLE_HEADER_SIZE);
+}
+
+void unloadWaveTable(WaveTable* table)
+{
+    if (table->mHasBuffer)
+    {
+        freeBuffer(table->mBuffer);
+    }
+    table->mHasBuffer = 0;
+}
+
+const WaveDefinition* getWaveDefinition(const WaveTable* table, int level)
+{
+    return &table->mWaves[min(level, int(table->mWaveAmount) - 1)];
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <prism/file.h>
+
+#include "gamevalue.h"
+
+// Mirrors one entry of WAVES.bin, see tools/wavecompiler.py
+struct WaveDefinition
+{
+    int32_t mEnemyAmount;
+    int32_t mSpawnBatch;
+    int32_t mSpawnInterval;
+    int32_t mEnemyType;
+    float mSpeed;
+    int32_t mChaserAmount;
+    GameValue mLife;
+    GameValue mStrength;
+    GameValue mLoveGain;
+};
+
+// WAVES.bin is read in place, so the layout has to match tools/wavecompiler.py on every platform, including 32 bit ones that align int64 to 4
+static_assert(sizeof(WaveDefinition) == 48, "WaveDefinition must match the WAVES.bin entry size");
+static_assert(offsetof(WaveDefinition, mLife) == 24, "WaveDefinition::mLife must match WAVES.bin");
+static_assert(offsetof(WaveDefinition, mStrength) == 32, "WaveDefinition::mStrength must match WAVES.bin");
+static_assert(offsetof(WaveDefinition, mLoveGain) == 40, "WaveDefinition::mLoveGain must match WAVES.bin");
+
+struct WaveTable
+{
+    Buffer mBuffer;
+    int mHasBuffer;
+    uint32_t mWaveAmount;
+    const WaveDefinition* mWaves;
+};
+
+void loadWaveTable(WaveTable* table, const char* path);
+void unloadWaveTable(WaveTable* table);
+
+const WaveDefinition* getWaveDefinition(const WaveTable* table, int level);
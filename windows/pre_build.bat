@@ -1,3 +1,5 @@
+python ..\tools\storycompiler.py ..\assets\game\STORY.def ..\assets\game\STORY.bin
+python ..\tools\wavecompiler.py ..\assets\game\WAVES.def ..\assets\game\WAVES.bin
 del ..\assets\*.exe
 del ..\assets\*.dll
 del ..\assets\*.exp